@@ -0,0 +1,845 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define BENCH_HAVE_FORK 1
+#endif
+
+#include "../heap/BinomialHeap.cpp"
+#include "../heap/ExternalHeap.cpp"
+#include "../heap/FibonachiHeap.cpp"
+#include "../heap/HeapK.cpp"
+#include "../heap/MultiQueue.cpp"
+#include "../heap/RadixHeap.cpp"
+#include "../heap/TopK.cpp"
+#include "../tree/BPlusTree.cpp"
+#include "Workloads.cpp"
+
+struct Config {
+    std::vector<size_t> sizes = {1000, 100000, 1000000};
+    std::string suite = "all";
+    std::string filter;
+    std::string format = "json";
+    uint64_t seed = 42;
+    size_t stride = 16;
+    bool fork = true;
+};
+
+struct Result {
+    std::string suite;
+    std::string structure;
+    std::string workload;
+    size_t n = 0;
+    size_t ops = 0;
+    double seconds = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    long peak_rss_kb = 0;
+    uint64_t checksum = 0;
+};
+
+class Recorder {
+    using Clock = std::chrono::steady_clock;
+
+    size_t stride;
+    size_t counter;
+    size_t ops;
+    std::vector<double> samples;
+    Clock::time_point begin;
+    Clock::time_point end;
+
+    double percentile(double p) const {
+        if (samples.empty()) {
+            return 0;
+        }
+        size_t i = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        return samples[i];
+    }
+
+public:
+    Recorder(size_t _stride): stride(std::max<size_t>(1, _stride)), counter(0), ops(0), samples() {}
+
+    void start() {
+        begin = Clock::now();
+    }
+
+    void stop() {
+        end = Clock::now();
+    }
+
+    template <typename F>
+    auto op(F f) -> decltype(f()) {
+        ++ops;
+        if (++counter != stride) {
+            return f();
+        }
+        counter = 0;
+        struct Sample {
+            Recorder& rec;
+            Clock::time_point from;
+            ~Sample() {
+                rec.samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - from).count());
+            }
+        } sample{*this, Clock::now()};
+        return f();
+    }
+
+    void merge(const Recorder& other) {
+        ops += other.ops;
+        samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+    }
+
+    void fill(Result& result) {
+        std::sort(samples.begin(), samples.end());
+        result.ops = ops;
+        result.seconds = std::chrono::duration<double>(end - begin).count();
+        result.p50 = percentile(0.5);
+        result.p90 = percentile(0.9);
+        result.p99 = percentile(0.99);
+        result.p999 = percentile(0.999);
+    }
+};
+
+template <typename Heap>
+struct HeapOps {
+    template <typename U>
+    static void push(Heap& heap, U&& x) {
+        heap.insert(std::forward<U>(x));
+    }
+
+    static auto pop(Heap& heap) {
+        return heap.pop();
+    }
+
+    template <typename Out>
+    static Out pop_n(Heap& heap, size_t n, Out out) {
+        return heap.pop_n(n, out);
+    }
+
+    template <typename It>
+    static void push_range(Heap& heap, It first, It last) {
+        heap.insert(first, last);
+    }
+};
+
+template <typename T, typename Container, typename Compare>
+struct HeapOps<std::priority_queue<T, Container, Compare>> {
+    using Heap = std::priority_queue<T, Container, Compare>;
+
+    template <typename U>
+    static void push(Heap& heap, U&& x) {
+        heap.push(std::forward<U>(x));
+    }
+
+    static T pop(Heap& heap) {
+        T result = heap.top();
+        heap.pop();
+        return result;
+    }
+
+    template <typename Out>
+    static Out pop_n(Heap& heap, size_t n, Out out) {
+        for (; n != 0 && !heap.empty(); --n) {
+            *out++ = pop(heap);
+        }
+        return out;
+    }
+
+    template <typename It>
+    static void push_range(Heap& heap, It first, It last) {
+        for (; first != last; ++first) {
+            heap.push(*first);
+        }
+    }
+};
+
+template <typename Tree>
+struct TreeOps {
+    static bool contains(const Tree& tree, uint64_t x) {
+        return tree.find(x) != tree.end();
+    }
+
+    static void erase(Tree& tree, uint64_t x) {
+        tree.erase(x);
+    }
+
+    static Tree checkpoint(const Tree& tree) {
+        std::stringstream stream;
+        tree.save(stream);
+        return Tree::load(stream);
+    }
+};
+
+template <>
+struct TreeOps<std::multiset<uint64_t>> {
+    static bool contains(const std::multiset<uint64_t>& tree, uint64_t x) {
+        return tree.find(x) != tree.end();
+    }
+
+    static void erase(std::multiset<uint64_t>& tree, uint64_t x) {
+        auto it = tree.find(x);
+        if (it != tree.end()) {
+            tree.erase(it);
+        }
+    }
+
+    static std::multiset<uint64_t> checkpoint(const std::multiset<uint64_t>& tree) {
+        std::stringstream stream;
+        for (auto x : tree) {
+            stream.write(reinterpret_cast<const char*>(&x), sizeof(x));
+        }
+        std::multiset<uint64_t> result;
+        uint64_t x;
+        while (stream.read(reinterpret_cast<char*>(&x), sizeof(x))) {
+            result.insert(result.end(), x);
+        }
+        return result;
+    }
+};
+
+template <unsigned int k>
+struct LearnedBPlusTree : BPlusTree<uint64_t, k> {
+    LearnedBPlusTree() {
+        this->enable_learned_index();
+    }
+
+    static LearnedBPlusTree load(std::istream& in) {
+        LearnedBPlusTree tree;
+        static_cast<BPlusTree<uint64_t, k>&>(tree) = BPlusTree<uint64_t, k>::load(in);
+        tree.enable_learned_index();
+        return tree;
+    }
+};
+
+template <typename Heap>
+Result heap_push_pop(const Config& config, size_t n, Distribution d) {
+    auto keys = make_keys(n, d, config.seed);
+    Recorder rec(config.stride);
+    Result result;
+    Heap heap;
+    rec.start();
+    for (auto x : keys) {
+        rec.op([&] { HeapOps<Heap>::push(heap, x); });
+    }
+    for (size_t i = 0; i < n; ++i) {
+        result.checksum += rec.op([&] { return HeapOps<Heap>::pop(heap); });
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Heap>
+Result heap_mix(const Config& config, size_t n, Distribution d) {
+    auto keys = make_keys(n + n / 2, d, config.seed);
+    std::mt19937_64 gen(config.seed + 1);
+    Recorder rec(config.stride);
+    Result result;
+    Heap heap;
+    size_t next = 0;
+    size_t live = 0;
+    rec.start();
+    for (; next < n / 2; ++next, ++live) {
+        rec.op([&] { HeapOps<Heap>::push(heap, keys[next]); });
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (live == 0 || (next < keys.size() && gen() % 2 == 0)) {
+            rec.op([&] { HeapOps<Heap>::push(heap, keys[next]); });
+            ++next;
+            ++live;
+        } else {
+            result.checksum += rec.op([&] { return HeapOps<Heap>::pop(heap); });
+            --live;
+        }
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Heap, bool batched>
+Result heap_tick(const Config& config, size_t n, Distribution d) {
+    const size_t batch = 64;
+    auto keys = make_keys(2 * n, d, config.seed);
+    std::vector<uint64_t> drained(batch);
+    Recorder rec(1);
+    Result result;
+    Heap heap;
+    for (size_t i = 0; i < n; ++i) {
+        HeapOps<Heap>::push(heap, keys[i]);
+    }
+    rec.start();
+    for (size_t next = n; next + batch <= keys.size(); next += batch) {
+        rec.op([&] {
+            if (batched) {
+                HeapOps<Heap>::pop_n(heap, batch, drained.begin());
+                HeapOps<Heap>::push_range(heap, keys.begin() + next, keys.begin() + next + batch);
+            } else {
+                for (auto& x : drained) {
+                    x = HeapOps<Heap>::pop(heap);
+                }
+                for (size_t i = next; i < next + batch; ++i) {
+                    HeapOps<Heap>::push(heap, keys[i]);
+                }
+            }
+        });
+        result.checksum += drained[0];
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Heap>
+Result heap_dijkstra(const Config& config, size_t n) {
+    using Entry = std::pair<uint64_t, uint32_t>;
+    Graph g = road_grid(std::max<uint32_t>(2, std::sqrt(static_cast<double>(n))), config.seed);
+    Recorder rec(config.stride);
+    Result result;
+    Heap heap;
+    rec.start();
+    result.checksum = dijkstra(g,
+            [&](const Entry& e) { rec.op([&] { HeapOps<Heap>::push(heap, e); }); },
+            [&](Entry& e) {
+                if (heap.empty()) {
+                    return false;
+                }
+                e = rec.op([&] { return HeapOps<Heap>::pop(heap); });
+                return true;
+            });
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Heap>
+class LockedHeap {
+    std::mutex lock;
+    Heap heap;
+
+public:
+    LockedHeap(size_t): lock(), heap() {}
+
+    template <typename U>
+    void insert(U&& x) {
+        std::lock_guard<std::mutex> guard(lock);
+        heap.insert(std::forward<U>(x));
+    }
+
+    template <typename U>
+    bool try_extract_max(U& result) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (heap.empty()) {
+            return false;
+        }
+        result = heap.pop();
+        return true;
+    }
+};
+
+template <typename Queue>
+Result concurrent_mix(const Config& config, size_t n, size_t threads) {
+    size_t per_thread = std::max<size_t>(1, n / threads);
+    auto keys = make_keys(n + per_thread * threads, Distribution::UNIFORM, config.seed);
+    Queue queue(threads);
+    for (size_t i = 0; i < n; ++i) {
+        queue.insert(keys[i]);
+    }
+    std::vector<Recorder> recs(threads, Recorder(config.stride));
+    std::vector<uint64_t> checksums(threads);
+    std::vector<std::thread> workers;
+    Recorder rec(config.stride);
+    Result result;
+    rec.start();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 gen(config.seed + t);
+            const uint64_t* next = keys.data() + n + t * per_thread;
+            for (size_t i = 0; i < per_thread; ++i) {
+                if (gen() % 2 == 0) {
+                    recs[t].op([&] { queue.insert(next[i]); });
+                } else {
+                    uint64_t x;
+                    if (recs[t].op([&] { return queue.try_extract_max(x); })) {
+                        checksums[t] += x;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    rec.stop();
+    for (size_t t = 0; t < threads; ++t) {
+        rec.merge(recs[t]);
+        result.checksum += checksums[t];
+    }
+    rec.fill(result);
+    return result;
+}
+
+class PriorityQueueTopK {
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> heap;
+    size_t capacity;
+
+public:
+    PriorityQueueTopK(size_t K): heap(), capacity(K) {}
+
+    void offer(uint64_t x) {
+        if (heap.size() < capacity) {
+            heap.push(x);
+        } else if (capacity != 0 && heap.top() < x) {
+            heap.pop();
+            heap.push(x);
+        }
+    }
+
+    template <typename It>
+    void offer(It first, It last) {
+        for (; first != last; ++first) {
+            offer(*first);
+        }
+    }
+
+    std::vector<uint64_t> extract_sorted() {
+        std::vector<uint64_t> result(heap.size());
+        for (size_t i = result.size(); i-- > 0;) {
+            result[i] = heap.top();
+            heap.pop();
+        }
+        return result;
+    }
+};
+
+template <typename Select, bool bulk>
+Result select_top(const Config& config, size_t n, Distribution d) {
+    const size_t K = 1024;
+    const size_t chunk = 4096;
+    auto keys = make_keys(n, d, config.seed);
+    Recorder rec(config.stride);
+    Result result;
+    Select select(K);
+    rec.start();
+    if (bulk) {
+        for (size_t i = 0; i < n; i += chunk) {
+            rec.op([&] { select.offer(keys.begin() + i, keys.begin() + std::min(n, i + chunk)); });
+        }
+    } else {
+        for (auto x : keys) {
+            rec.op([&] { select.offer(x); });
+        }
+    }
+    auto best = select.extract_sorted();
+    rec.stop();
+    rec.fill(result);
+    for (auto x : best) {
+        result.checksum += x;
+    }
+    return result;
+}
+
+template <typename Heap>
+struct ExternalOps {
+    static std::unique_ptr<Heap> make(size_t) {
+        return std::unique_ptr<Heap>(new Heap());
+    }
+};
+
+template <typename T, int k, typename Compare>
+struct ExternalOps<ExternalHeapMax<T, k, Compare>> {
+    static std::unique_ptr<ExternalHeapMax<T, k, Compare>> make(size_t n) {
+        return std::unique_ptr<ExternalHeapMax<T, k, Compare>>(
+                new ExternalHeapMax<T, k, Compare>(std::max<size_t>(1024, n / 16)));
+    }
+};
+
+template <typename Heap>
+Result external_spill_merge(const Config& config, size_t n) {
+    auto keys = make_keys(n, Distribution::UNIFORM, config.seed);
+    auto heap = ExternalOps<Heap>::make(n);
+    Recorder rec(config.stride);
+    Result result;
+    rec.start();
+    for (auto x : keys) {
+        rec.op([&] { heap->insert(x); });
+    }
+    while (!heap->empty()) {
+        result.checksum += rec.op([&] { return heap->pop(); });
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Tree>
+Result tree_insert(const Config& config, size_t n, Distribution d) {
+    auto keys = make_keys(n, d, config.seed);
+    Recorder rec(config.stride);
+    Result result;
+    Tree tree;
+    rec.start();
+    for (auto x : keys) {
+        rec.op([&] { tree.insert(x); });
+    }
+    rec.stop();
+    rec.fill(result);
+    result.checksum = tree.size();
+    return result;
+}
+
+template <typename Tree>
+Result tree_lookup(const Config& config, size_t n, Distribution d) {
+    auto keys = make_keys(n, d, config.seed);
+    Tree tree;
+    for (auto x : keys) {
+        tree.insert(x);
+    }
+    std::mt19937_64 gen(config.seed + 1);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for (size_t i = 1; i < keys.size(); i += 2) {
+        keys[i] = gen();
+    }
+    Recorder rec(config.stride);
+    Result result;
+    rec.start();
+    for (auto x : keys) {
+        result.checksum += rec.op([&] { return TreeOps<Tree>::contains(tree, x); });
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Tree>
+Result tree_range_scan(const Config& config, size_t n, Distribution d) {
+    const size_t scan_length = 64;
+    auto keys = make_keys(n, d, config.seed);
+    Tree tree;
+    for (auto x : keys) {
+        tree.insert(x);
+    }
+    std::mt19937_64 gen(config.seed + 1);
+    Recorder rec(config.stride);
+    Result result;
+    rec.start();
+    for (size_t i = 0; i < std::max<size_t>(1, n / scan_length); ++i) {
+        uint64_t from = keys[gen() % keys.size()];
+        result.checksum += rec.op([&] {
+            uint64_t sum = 0;
+            auto it = tree.lower_bound(from);
+            for (size_t j = 0; j < scan_length && it != tree.end(); ++j, ++it) {
+                sum += *it;
+            }
+            return sum;
+        });
+    }
+    rec.stop();
+    rec.fill(result);
+    return result;
+}
+
+template <typename Tree>
+Result tree_checkpoint(const Config& config, size_t n, Distribution d) {
+    const size_t rounds = 5;
+    auto keys = make_keys(n, d, config.seed);
+    Tree tree;
+    for (auto x : keys) {
+        tree.insert(x);
+    }
+    Recorder rec(1);
+    Result result;
+    rec.start();
+    for (size_t i = 0; i < rounds; ++i) {
+        tree = rec.op([&] { return TreeOps<Tree>::checkpoint(tree); });
+    }
+    rec.stop();
+    rec.fill(result);
+    result.checksum = tree.size();
+    return result;
+}
+
+template <typename Tree>
+Result tree_churn(const Config& config, size_t n, Distribution d) {
+    auto keys = make_keys(2 * n, d, config.seed);
+    std::vector<uint64_t> live(keys.begin(), keys.begin() + n);
+    Tree tree;
+    for (auto x : live) {
+        tree.insert(x);
+    }
+    std::mt19937_64 gen(config.seed + 1);
+    Recorder rec(config.stride);
+    Result result;
+    rec.start();
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = gen() % live.size();
+        rec.op([&] { TreeOps<Tree>::erase(tree, live[j]); });
+        live[j] = keys[n + i];
+        rec.op([&] { tree.insert(live[j]); });
+    }
+    rec.stop();
+    rec.fill(result);
+    result.checksum = tree.size();
+    return result;
+}
+
+struct Bench {
+    std::string suite;
+    std::string structure;
+    std::string workload;
+    std::function<Result(const Config&, size_t)> run;
+};
+
+template <typename Heap>
+void add_heap(std::vector<Bench>& benches, const std::string& name) {
+    for (auto d : {Distribution::UNIFORM, Distribution::SORTED, Distribution::ZIPF}) {
+        std::string dist = distribution_name(d);
+        benches.push_back({"heap", name, "push_pop_" + dist,
+                [d](const Config& c, size_t n) { return heap_push_pop<Heap>(c, n, d); }});
+        benches.push_back({"heap", name, "mix_" + dist,
+                [d](const Config& c, size_t n) { return heap_mix<Heap>(c, n, d); }});
+        benches.push_back({"heap", name, "tick_single_" + dist,
+                [d](const Config& c, size_t n) { return heap_tick<Heap, false>(c, n, d); }});
+        benches.push_back({"heap", name, "tick_batch_" + dist,
+                [d](const Config& c, size_t n) { return heap_tick<Heap, true>(c, n, d); }});
+    }
+}
+
+template <typename Heap>
+void add_dijkstra(std::vector<Bench>& benches, const std::string& name) {
+    benches.push_back({"dijkstra", name, "road_grid",
+            [](const Config& c, size_t n) { return heap_dijkstra<Heap>(c, n); }});
+}
+
+template <typename Select>
+void add_select(std::vector<Bench>& benches, const std::string& name) {
+    for (auto d : {Distribution::UNIFORM, Distribution::SORTED}) {
+        std::string dist = distribution_name(d);
+        benches.push_back({"select", name, "stream_" + dist,
+                [d](const Config& c, size_t n) { return select_top<Select, false>(c, n, d); }});
+        benches.push_back({"select", name, "bulk_" + dist,
+                [d](const Config& c, size_t n) { return select_top<Select, true>(c, n, d); }});
+    }
+}
+
+template <typename Heap>
+void add_external(std::vector<Bench>& benches, const std::string& name) {
+    benches.push_back({"external", name, "spill_merge_uniform",
+            [](const Config& c, size_t n) { return external_spill_merge<Heap>(c, n); }});
+}
+
+template <typename Queue>
+void add_concurrent(std::vector<Bench>& benches, const std::string& name) {
+    for (size_t threads : {1, 2, 4, 8}) {
+        benches.push_back({"concurrent", name, "mix_" + std::to_string(threads) + "t",
+                [threads](const Config& c, size_t n) { return concurrent_mix<Queue>(c, n, threads); }});
+    }
+}
+
+template <typename Tree>
+void add_tree(std::vector<Bench>& benches, const std::string& name) {
+    for (auto d : {Distribution::UNIFORM, Distribution::SORTED, Distribution::ZIPF}) {
+        std::string dist = distribution_name(d);
+        benches.push_back({"tree", name, "insert_" + dist,
+                [d](const Config& c, size_t n) { return tree_insert<Tree>(c, n, d); }});
+        benches.push_back({"tree", name, "lookup_" + dist,
+                [d](const Config& c, size_t n) { return tree_lookup<Tree>(c, n, d); }});
+    }
+    benches.push_back({"tree", name, "range_scan_uniform",
+            [](const Config& c, size_t n) { return tree_range_scan<Tree>(c, n, Distribution::UNIFORM); }});
+    benches.push_back({"tree", name, "churn_uniform",
+            [](const Config& c, size_t n) { return tree_churn<Tree>(c, n, Distribution::UNIFORM); }});
+    benches.push_back({"tree", name, "checkpoint_uniform",
+            [](const Config& c, size_t n) { return tree_checkpoint<Tree>(c, n, Distribution::UNIFORM); }});
+}
+
+std::vector<Bench> all_benches() {
+    using Entry = std::pair<uint64_t, uint32_t>;
+    using MinCompare = std::greater<Entry>;
+    std::vector<Bench> benches;
+    add_heap<HeapKMax<uint64_t, 2>>(benches, "HeapKMax<2>");
+    add_heap<HeapKMax<uint64_t, 4>>(benches, "HeapKMax<4>");
+    add_heap<HeapKMax<uint64_t, 8>>(benches, "HeapKMax<8>");
+    add_heap<BinomialHeapMax<uint64_t>>(benches, "BinomialHeapMax");
+    add_heap<FibonachiHeap<uint64_t>>(benches, "FibonachiHeap");
+    add_heap<std::priority_queue<uint64_t>>(benches, "std::priority_queue");
+    add_dijkstra<RadixHeapMin<Entry>>(benches, "RadixHeapMin");
+    add_dijkstra<HeapKMax<Entry, 2, MinCompare>>(benches, "HeapKMax<2>");
+    add_dijkstra<HeapKMax<Entry, 4, MinCompare>>(benches, "HeapKMax<4>");
+    add_dijkstra<HeapKMax<Entry, 8, MinCompare>>(benches, "HeapKMax<8>");
+    add_dijkstra<BinomialHeapMax<Entry, MinCompare>>(benches, "BinomialHeapMax");
+    add_dijkstra<FibonachiHeap<Entry, MinCompare>>(benches, "FibonachiHeap");
+    add_dijkstra<std::priority_queue<Entry, std::vector<Entry>, MinCompare>>(benches, "std::priority_queue");
+    add_select<TopK<uint64_t, 4>>(benches, "TopK<4>");
+    add_select<PriorityQueueTopK>(benches, "std::priority_queue");
+    add_external<ExternalHeapMax<uint64_t, 4>>(benches, "ExternalHeapMax<4>");
+    add_external<HeapKMax<uint64_t, 4>>(benches, "HeapKMax<4>");
+    add_concurrent<MultiQueue<uint64_t, 4>>(benches, "MultiQueue<4>");
+    add_concurrent<LockedHeap<HeapKMax<uint64_t, 4>>>(benches, "HeapKMax<4>+mutex");
+    add_tree<BPlusTree<uint64_t, 2>>(benches, "BPlusTree<2>");
+    add_tree<BPlusTree<uint64_t, 8>>(benches, "BPlusTree<8>");
+    add_tree<BPlusTree<uint64_t, 32>>(benches, "BPlusTree<32>");
+    add_tree<LearnedBPlusTree<8>>(benches, "BPlusTree<8>+learned");
+    add_tree<std::multiset<uint64_t>>(benches, "std::multiset");
+    return benches;
+}
+
+long peak_rss_kb() {
+#ifdef BENCH_HAVE_FORK
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void print_header(const Config& config) {
+    if (config.format == "csv") {
+        std::printf("suite,structure,workload,n,ops,seconds,ops_per_sec,"
+                "p50_ns,p90_ns,p99_ns,p999_ns,peak_rss_kb,checksum\n");
+    }
+}
+
+void print_result(const Config& config, const Result& r) {
+    double throughput = r.seconds > 0 ? r.ops / r.seconds : 0;
+    if (config.format == "csv") {
+        std::printf("%s,\"%s\",%s,%zu,%zu,%.6f,%.1f,%.1f,%.1f,%.1f,%.1f,%ld,%llu\n",
+                r.suite.c_str(), r.structure.c_str(), r.workload.c_str(), r.n, r.ops,
+                r.seconds, throughput, r.p50, r.p90, r.p99, r.p999, r.peak_rss_kb,
+                static_cast<unsigned long long>(r.checksum));
+    } else {
+        std::printf("{\"suite\":\"%s\",\"structure\":\"%s\",\"workload\":\"%s\",\"n\":%zu,"
+                "\"ops\":%zu,\"seconds\":%.6f,\"ops_per_sec\":%.1f,\"p50_ns\":%.1f,"
+                "\"p90_ns\":%.1f,\"p99_ns\":%.1f,\"p999_ns\":%.1f,\"peak_rss_kb\":%ld,"
+                "\"checksum\":%llu}\n",
+                r.suite.c_str(), r.structure.c_str(), r.workload.c_str(), r.n, r.ops,
+                r.seconds, throughput, r.p50, r.p90, r.p99, r.p999, r.peak_rss_kb,
+                static_cast<unsigned long long>(r.checksum));
+    }
+    std::fflush(stdout);
+}
+
+void run_one(const Config& config, const Bench& bench, size_t n) {
+    auto body = [&] {
+        Result result = bench.run(config, n);
+        result.suite = bench.suite;
+        result.structure = bench.structure;
+        result.workload = bench.workload;
+        result.n = n;
+        result.peak_rss_kb = peak_rss_kb();
+        print_result(config, result);
+    };
+#ifdef BENCH_HAVE_FORK
+    if (config.fork) {
+        std::fflush(stdout);
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            body();
+            std::_Exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::fprintf(stderr, "%s %s %s n=%zu failed\n",
+                    bench.suite.c_str(), bench.structure.c_str(), bench.workload.c_str(), n);
+        }
+        return;
+    }
+#endif
+    body();
+}
+
+std::vector<size_t> parse_sizes(const char* arg) {
+    std::vector<size_t> sizes;
+    std::string s(arg);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = s.size();
+        }
+        sizes.push_back(std::strtoull(s.c_str() + pos, nullptr, 10));
+        pos = comma + 1;
+    }
+    return sizes;
+}
+
+void usage(const char* name) {
+    std::fprintf(stderr,
+            "usage: %s [--suite all|heap|dijkstra|select|external|concurrent|tree] [--filter SUBSTRING]\n"
+            "          [--sizes 1000,100000,...] [--format json|csv] [--seed N]\n"
+            "          [--stride N] [--no-fork] [--list]\n", name);
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--suite" && has_value) {
+            config.suite = argv[++i];
+        } else if (arg == "--filter" && has_value) {
+            config.filter = argv[++i];
+        } else if (arg == "--sizes" && has_value) {
+            config.sizes = parse_sizes(argv[++i]);
+        } else if (arg == "--format" && has_value) {
+            config.format = argv[++i];
+        } else if (arg == "--seed" && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--stride" && has_value) {
+            config.stride = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--no-fork") {
+            config.fork = false;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    print_header(config);
+    for (auto& bench : all_benches()) {
+        if (config.suite != "all" && config.suite != bench.suite) {
+            continue;
+        }
+        std::string id = bench.suite + "/" + bench.structure + "/" + bench.workload;
+        if (!config.filter.empty() && id.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        if (list) {
+            std::printf("%s\n", id.c_str());
+            continue;
+        }
+        for (auto n : config.sizes) {
+            run_one(config, bench, n);
+        }
+    }
+    return 0;
+}
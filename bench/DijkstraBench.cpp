@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "../heap/BinomialHeap.cpp"
+#include "../heap/FibonachiHeap.cpp"
+#include "../heap/HeapK.cpp"
+#include "../heap/RadixHeap.cpp"
+#include "Workloads.cpp"
+
+using Entry = std::pair<uint64_t, uint32_t>;
+
+template <typename Heap>
+uint64_t run_max_heap(const Graph& g) {
+    Heap heap;
+    return dijkstra(g,
+            [&](const Entry& e) { heap.insert(e); },
+            [&](Entry& e) {
+                if (heap.empty()) {
+                    return false;
+                }
+                e = heap.get_max();
+                heap.extract_max();
+                return true;
+            });
+}
+
+uint64_t run_std(const Graph& g) {
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    return dijkstra(g,
+            [&](const Entry& e) { heap.push(e); },
+            [&](Entry& e) {
+                if (heap.empty()) {
+                    return false;
+                }
+                e = heap.top();
+                heap.pop();
+                return true;
+            });
+}
+
+uint64_t run_radix(const Graph& g) {
+    RadixHeapMin<Entry> heap;
+    return dijkstra(g,
+            [&](const Entry& e) { heap.insert(e); },
+            [&](Entry& e) {
+                if (heap.empty()) {
+                    return false;
+                }
+                e = heap.get_min();
+                heap.extract_min();
+                return true;
+            });
+}
+
+template <typename F>
+void measure(const char* name, const Graph& g, F f) {
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t checksum = f(g);
+    auto end = std::chrono::steady_clock::now();
+    std::printf("%-22s %10.2f ms  checksum %llu\n", name,
+            std::chrono::duration<double, std::milli>(end - begin).count(),
+            static_cast<unsigned long long>(checksum));
+}
+
+int main(int argc, char** argv) {
+    uint32_t side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    Graph g = road_grid(side, 42);
+    std::printf("grid %ux%u, %zu edges\n", side, side, g.to.size());
+    measure("RadixHeapMin", g, run_radix);
+    measure("HeapKMax<2>", g, run_max_heap<HeapKMax<Entry, 2, std::greater<Entry>>>);
+    measure("HeapKMax<4>", g, run_max_heap<HeapKMax<Entry, 4, std::greater<Entry>>>);
+    measure("HeapKMax<8>", g, run_max_heap<HeapKMax<Entry, 8, std::greater<Entry>>>);
+    measure("BinomialHeapMax", g, run_max_heap<BinomialHeapMax<Entry, std::greater<Entry>>>);
+    measure("FibonachiHeap", g, run_max_heap<FibonachiHeap<Entry, std::greater<Entry>>>);
+    measure("std::priority_queue", g, run_std);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../heap/BinomialHeap.cpp"
+#include "../heap/FibonachiHeap.cpp"
+#include "../heap/HeapK.cpp"
+
+struct Payload {
+    static size_t copies;
+    std::string text;
+
+    Payload(std::string s): text(std::move(s)) {}
+    Payload(const Payload& other): text(other.text) {
+        ++copies;
+    }
+    Payload(Payload&&) = default;
+    Payload& operator=(const Payload& other) {
+        ++copies;
+        text = other.text;
+        return *this;
+    }
+    Payload& operator=(Payload&&) = default;
+
+    friend bool operator<(const Payload& first, const Payload& second) {
+        return first.text < second.text;
+    }
+};
+
+size_t Payload::copies = 0;
+
+std::vector<std::string> make_strings(size_t n, size_t len) {
+    std::mt19937 gen(7);
+    std::vector<std::string> result(n);
+    for (auto& s : result) {
+        s.resize(len);
+        for (auto& c : s) {
+            c = 'a' + gen() % 26;
+        }
+    }
+    return result;
+}
+
+template <typename Heap>
+size_t round_trip_copy(const std::vector<std::string>& input) {
+    Heap heap;
+    size_t total = 0;
+    for (auto& s : input) {
+        Payload p(s);
+        heap.insert(p);
+    }
+    while (!heap.empty()) {
+        Payload p = heap.get_max();
+        heap.extract_max();
+        total += p.text.size();
+    }
+    return total;
+}
+
+template <typename Heap>
+size_t round_trip_move(const std::vector<std::string>& input) {
+    Heap heap;
+    size_t total = 0;
+    for (auto& s : input) {
+        heap.emplace(s);
+    }
+    while (!heap.empty()) {
+        Payload p = heap.pop();
+        total += p.text.size();
+    }
+    return total;
+}
+
+template <typename F>
+void measure(const char* name, const std::vector<std::string>& input, F f) {
+    Payload::copies = 0;
+    auto begin = std::chrono::steady_clock::now();
+    size_t total = f(input);
+    auto end = std::chrono::steady_clock::now();
+    std::printf("%-28s %10.2f ms  copies %10zu  bytes %zu\n", name,
+            std::chrono::duration<double, std::milli>(end - begin).count(),
+            Payload::copies, total);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::atoi(argv[1]) : 200000;
+    size_t len = argc > 2 ? std::atoi(argv[2]) : 64;
+    auto input = make_strings(n, len);
+    std::printf("%zu strings of length %zu\n", n, len);
+    measure("HeapKMax<4> copy", input, round_trip_copy<HeapKMax<Payload, 4>>);
+    measure("HeapKMax<4> move", input, round_trip_move<HeapKMax<Payload, 4>>);
+    measure("BinomialHeapMax copy", input, round_trip_copy<BinomialHeapMax<Payload>>);
+    measure("BinomialHeapMax move", input, round_trip_move<BinomialHeapMax<Payload>>);
+    measure("FibonachiHeap copy", input, round_trip_copy<FibonachiHeap<Payload>>);
+    measure("FibonachiHeap move", input, round_trip_move<FibonachiHeap<Payload>>);
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class Distribution {UNIFORM, SORTED, ZIPF};
+
+inline const char* distribution_name(Distribution d) {
+    switch (d) {
+    case Distribution::UNIFORM:
+        return "uniform";
+    case Distribution::SORTED:
+        return "sorted";
+    case Distribution::ZIPF:
+        return "zipf";
+    }
+    return "";
+}
+
+class Zipf {
+    uint64_t n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+    std::uniform_real_distribution<double> unit;
+
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+public:
+    Zipf(uint64_t _n, double _theta = 0.99)
+        : n(std::max<uint64_t>(_n, 2))
+        , theta(_theta)
+        , alpha(1.0 / (1.0 - _theta))
+        , zetan(zeta(n, _theta))
+        , eta(0)
+        , unit(0.0, 1.0)
+    {
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+    }
+
+    template <typename Gen>
+    uint64_t operator()(Gen& gen) {
+        double u = unit(gen);
+        double uz = u * zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta)) {
+            return 1;
+        }
+        return std::min<uint64_t>(n - 1,
+                static_cast<uint64_t>(n * std::pow(eta * u - eta + 1.0, alpha)));
+    }
+};
+
+inline std::vector<uint64_t> make_keys(size_t n, Distribution d, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<uint64_t> keys(n);
+    switch (d) {
+    case Distribution::UNIFORM:
+        for (auto& x : keys) {
+            x = gen();
+        }
+        break;
+    case Distribution::SORTED:
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = i;
+        }
+        break;
+    case Distribution::ZIPF: {
+        Zipf zipf(n);
+        for (auto& x : keys) {
+            x = zipf(gen);
+        }
+        break;
+    }
+    }
+    return keys;
+}
+
+struct Graph {
+    std::vector<uint32_t> start;
+    std::vector<uint32_t> to;
+    std::vector<uint32_t> weight;
+
+    size_t vertices() const {
+        return start.size() - 1;
+    }
+};
+
+inline Graph road_grid(uint32_t side, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint32_t> dist(1, 1000);
+    size_t n = static_cast<size_t>(side) * side;
+    std::vector<uint32_t> degree(n + 1, 0);
+    for (uint32_t r = 0; r < side; ++r) {
+        for (uint32_t c = 0; c < side; ++c) {
+            uint32_t u = r * side + c;
+            degree[u] = (c > 0) + (c + 1 < side) + (r > 0) + (r + 1 < side);
+        }
+    }
+    Graph g;
+    g.start.resize(n + 1, 0);
+    for (size_t u = 0; u < n; ++u) {
+        g.start[u + 1] = g.start[u] + degree[u];
+    }
+    g.to.resize(g.start[n]);
+    g.weight.resize(g.start[n]);
+    std::vector<uint32_t> pos(g.start.begin(), g.start.end() - 1);
+    auto add = [&](uint32_t u, uint32_t v) {
+        uint32_t w = dist(gen);
+        g.to[pos[u]] = v;
+        g.weight[pos[u]++] = w;
+        g.to[pos[v]] = u;
+        g.weight[pos[v]++] = w;
+    };
+    for (uint32_t r = 0; r < side; ++r) {
+        for (uint32_t c = 0; c < side; ++c) {
+            uint32_t u = r * side + c;
+            if (c + 1 < side) {
+                add(u, u + 1);
+            }
+            if (r + 1 < side) {
+                add(u, u + side);
+            }
+        }
+    }
+    return g;
+}
+
+template <typename Push, typename Pop>
+uint64_t dijkstra(const Graph& g, Push push, Pop pop) {
+    using Entry = std::pair<uint64_t, uint32_t>;
+    std::vector<uint64_t> dist(g.vertices(), UINT64_MAX);
+    dist[0] = 0;
+    push(Entry(0, 0));
+    Entry e;
+    while (pop(e)) {
+        auto [d, u] = e;
+        if (d != dist[u]) {
+            continue;
+        }
+        for (uint32_t i = g.start[u]; i < g.start[u + 1]; ++i) {
+            uint64_t nd = d + g.weight[i];
+            if (nd < dist[g.to[i]]) {
+                dist[g.to[i]] = nd;
+                push(Entry(nd, g.to[i]));
+            }
+        }
+    }
+    uint64_t checksum = 0;
+    for (auto d : dist) {
+        checksum += d;
+    }
+    return checksum;
+}
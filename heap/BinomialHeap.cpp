@@ -2,9 +2,13 @@
 #include <forward_list>
 #include <memory>
 #include <functional>
+#include <utility>
+#include <vector>
 
-template <typename T, typename Compare = std::less<T>>
-class BinomialHeapMax {
+#include "HeapStats.cpp"
+
+template <typename T, typename Compare = std::less<T>, typename Stats = HeapNoStats>
+class BinomialHeapMax : private Stats {
     class Node {
     public:
         size_t rk;
@@ -13,9 +17,10 @@ class BinomialHeapMax {
         std::unique_ptr<Node> brother;
         Node* parent;
     public:
-        Node(const T& _data)
+        template <typename... Args>
+        Node(Args&&... args)
             : rk(0)
-            , data(_data)
+            , data(std::forward<Args>(args)...)
             , child(nullptr)
             , brother(nullptr)
         {}
@@ -24,8 +29,10 @@ class BinomialHeapMax {
             return rk;
         }
 
-        static std::unique_ptr<Node> merge(std::unique_ptr<Node>&& first, std::unique_ptr<Node>&& second) {
+        static std::unique_ptr<Node> merge(std::unique_ptr<Node>&& first, std::unique_ptr<Node>&& second, Stats& stats) {
+            stats.on_compare();
             if (Compare()(first->data, second->data)) {
+                stats.on_swap();
                 swap(first, second);
             }
             second->brother = std::move(first->child);
@@ -34,7 +41,7 @@ class BinomialHeapMax {
             return std::move(first);
         }
 
-        T get_data() const {
+        const T& get_data() const {
             return data;
         }
     };
@@ -42,11 +49,16 @@ class BinomialHeapMax {
     std::vector<std::unique_ptr<Node>> roots;
     size_t sz;
     size_t cur_max;
+
+    Stats& tally() {
+        return *this;
+    }
     
     friend std::pair<std::unique_ptr<Node>, std::unique_ptr<Node>> full_sumator(
             std::unique_ptr<Node>&& first,
             std::unique_ptr<Node>&& second,
-            std::unique_ptr<Node>&& third) {
+            std::unique_ptr<Node>&& third,
+            Stats& stats) {
         if (!first) {
             swap(first, third);
             if (!first) {
@@ -64,16 +76,38 @@ class BinomialHeapMax {
             return {nullptr, std::move(first)};
         }
         if (!third) {
-            return {Node::merge(std::move(first), std::move(second)), nullptr};
+            return {Node::merge(std::move(first), std::move(second), stats), nullptr};
         }
-        return {Node::merge(std::move(first), std::move(second)), std::move(third)};
+        return {Node::merge(std::move(first), std::move(second), stats), std::move(third)};
     }
 
-    BinomialHeapMax(const T& data): roots(), sz(1) {
-        roots.emplace_back(new Node(data));
+    BinomialHeapMax(std::unique_ptr<Node>&& node): Stats(), roots(), sz(1) {
+        roots.push_back(std::move(node));
         cur_max = 0;
     }
 
+    void add_tree(std::unique_ptr<Node>&& tree) {
+        size_t r = tree->rank();
+        size_t start = r;
+        while (r < roots.size() && roots[r]) {
+            tree = Node::merge(std::move(roots[r]), std::move(tree), tally());
+            ++r;
+        }
+        tally().on_carry_chain(r - start);
+        if (r >= roots.size()) {
+            roots.resize(r + 1);
+        }
+        roots[r] = std::move(tree);
+    }
+
+    static void prefetch(const Node* node) {
+#if defined(__GNUC__)
+        __builtin_prefetch(node);
+#else
+        (void)node;
+#endif
+    }
+
     void find_max() {
         if (empty()) {
             cur_max = 0;
@@ -81,6 +115,7 @@ class BinomialHeapMax {
         cur_max = roots.size() - 1;
         for (size_t i = 0; i < roots.size(); ++i) {
             if (roots[i]) {
+                tally().on_compare();
                 if (Compare()(roots[cur_max]->get_data(), roots[i]->get_data())) {
                     cur_max = i;
                 }
@@ -89,36 +124,51 @@ class BinomialHeapMax {
     }
 
 public:
-    BinomialHeapMax(): roots(), sz(0), cur_max(0) {}
+    BinomialHeapMax(): Stats(), roots(), sz(0), cur_max(0) {}
 
     bool empty() const {
         return roots.empty();
     }
+
+    size_t size() const {
+        return sz;
+    }
     
     friend BinomialHeapMax merge(BinomialHeapMax& first, BinomialHeapMax& second) {
         BinomialHeapMax ans;
+        ans.tally() = std::move(first.tally());
         std::unique_ptr<Node> r;
+        size_t chain = 0;
+        size_t longest = 0;
+        auto carry = [&]() {
+            chain = r ? chain + 1 : 0;
+            longest = std::max(longest, chain);
+        };
         size_t i = 0;
         for (; i < first.roots.size() && i < second.roots.size(); ++i) {
-            auto [next, prev] = full_sumator(std::move(first.roots[i]), std::move(second.roots[i]), std::move(r));
+            auto [next, prev] = full_sumator(std::move(first.roots[i]), std::move(second.roots[i]), std::move(r), ans.tally());
             ans.roots.push_back(std::move(prev));
             r = std::move(next);
+            carry();
         }
         for (; i < first.roots.size(); ++i) {
             std::unique_ptr<Node> tmp;
-            auto [next, prev] = full_sumator(std::move(first.roots[i]), std::move(tmp), std::move(r));
+            auto [next, prev] = full_sumator(std::move(first.roots[i]), std::move(tmp), std::move(r), ans.tally());
             ans.roots.push_back(std::move(prev));
             r = std::move(next);
+            carry();
         }
         for (; i < second.roots.size(); ++i) {
             std::unique_ptr<Node> tmp;
-            auto [next, prev] = full_sumator(std::move(tmp), std::move(second.roots[i]), std::move(r));
+            auto [next, prev] = full_sumator(std::move(tmp), std::move(second.roots[i]), std::move(r), ans.tally());
             ans.roots.push_back(std::move(prev));
             r = std::move(next);
+            carry();
         }
         if (r) {
             ans.roots.push_back(std::move(r));
         }
+        ans.tally().on_carry_chain(longest);
         ans.sz = first.sz + second.sz;
         first.sz = 0;
         second.sz = 0;
@@ -131,17 +181,92 @@ public:
     }
 
     void insert(const T& data) {
-        BinomialHeapMax other(data);
+        emplace(data);
+    }
+
+    void insert(T&& data) {
+        tally().on_move();
+        emplace(std::move(data));
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        tally().on_allocation();
+        BinomialHeapMax other(std::unique_ptr<Node>(new Node(std::forward<Args>(args)...)));
         *this = merge(*this, other);
     }
 
+    template <typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first) {
+            tally().on_allocation();
+            add_tree(std::unique_ptr<Node>(new Node(*first)));
+            ++sz;
+        }
+        find_max();
+    }
+
     T get_max() const {
         return roots[cur_max]->get_data();
     }
 
+    const T& top() const {
+        return roots[cur_max]->get_data();
+    }
+
+    T pop() {
+        tally().on_move();
+        T result = std::move(roots[cur_max]->data);
+        extract_max();
+        return result;
+    }
+
+    template <typename Out>
+    Out pop_n(size_t n, Out out) {
+        n = std::min(n, sz);
+        if (n == 0) {
+            return out;
+        }
+        auto less = [this](const std::unique_ptr<Node>& first, const std::unique_ptr<Node>& second) {
+            tally().on_compare();
+            return Compare()(first->data, second->data);
+        };
+        std::vector<std::unique_ptr<Node>> candidates;
+        for (auto& tree : roots) {
+            if (tree) {
+                prefetch(tree->child.get());
+                candidates.push_back(std::move(tree));
+            }
+        }
+        roots.clear();
+        std::make_heap(candidates.begin(), candidates.end(), less);
+        for (size_t i = 0; i < n; ++i) {
+            std::pop_heap(candidates.begin(), candidates.end(), less);
+            std::unique_ptr<Node> best = std::move(candidates.back());
+            candidates.pop_back();
+            for (std::unique_ptr<Node> c = std::move(best->child); c;) {
+                std::unique_ptr<Node> next = std::move(c->brother);
+                prefetch(c->child.get());
+                candidates.push_back(std::move(c));
+                std::push_heap(candidates.begin(), candidates.end(), less);
+                c = std::move(next);
+            }
+            tally().on_move();
+            *out++ = std::move(best->data);
+        }
+        sz -= n;
+        for (auto& tree : candidates) {
+            add_tree(std::move(tree));
+        }
+        find_max();
+        return out;
+    }
+
     void extract_max() {
         if (roots.size() == 1) {
+            Stats stats = std::move(tally());
             *this = BinomialHeapMax();
+            tally() = std::move(stats);
             return;
         }
         auto tmp = std::move(roots[cur_max]);
@@ -162,4 +287,8 @@ public:
         }
         *this = merge(*this, other);
     }
+
+    const Stats& stats() const {
+        return *this;
+    }
 };
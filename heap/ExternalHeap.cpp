@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <stdlib.h>
+#include <unistd.h>
+#define EXTERNAL_HEAP_HAVE_MKSTEMP 1
+#endif
+
+#include "HeapK.cpp"
+
+template <typename T, int k = 4, typename Compare = std::less<T>>
+class ExternalHeapMax {
+    static_assert(std::is_trivially_copyable<T>::value, "ExternalHeapMax writes elements as raw bytes");
+
+    class Run {
+        std::FILE* file;
+        std::string path;
+        std::vector<T> buffer;
+        size_t pos;
+        size_t remaining;
+        size_t total;
+
+        void fill() {
+            size_t cnt = std::min(remaining, buffer.capacity());
+            buffer.resize(cnt);
+            if (std::fread(buffer.data(), sizeof(T), cnt, file) != cnt) {
+                throw std::runtime_error("ExternalHeapMax: short read from run file");
+            }
+            remaining -= cnt;
+            pos = 0;
+        }
+
+        void close() {
+            std::fclose(file);
+            if (!path.empty()) {
+                std::remove(path.c_str());
+            }
+        }
+
+    public:
+        Run(std::FILE* _file, std::string _path, size_t cnt, size_t block)
+            : file(_file)
+            , path(std::move(_path))
+            , buffer()
+            , pos(0)
+            , remaining(cnt)
+            , total(cnt)
+        {
+            try {
+                buffer.reserve(block);
+                std::rewind(file);
+                fill();
+            } catch (...) {
+                close();
+                throw;
+            }
+        }
+
+        Run(const Run&) = delete;
+        Run& operator=(const Run&) = delete;
+
+        ~Run() {
+            close();
+        }
+
+        const T& head() const {
+            return buffer[pos];
+        }
+
+        size_t size() const {
+            return buffer.size() - pos + remaining;
+        }
+
+        size_t position() const {
+            return total - size();
+        }
+
+        void seek(size_t index) {
+            if (std::fseek(file, static_cast<long>(index * sizeof(T)), SEEK_SET) != 0) {
+                throw std::runtime_error("ExternalHeapMax: cannot seek in run file");
+            }
+            remaining = total - index;
+            fill();
+        }
+
+        bool next() {
+            if (++pos == buffer.size()) {
+                if (remaining == 0) {
+                    return false;
+                }
+                fill();
+            }
+            return true;
+        }
+    };
+
+    struct HeadCompare {
+        bool operator()(const std::pair<T, size_t>& first, const std::pair<T, size_t>& second) const {
+            return Compare()(first.first, second.first);
+        }
+    };
+
+    HeapKMax<T, k, Compare> buffer;
+    HeapKMax<std::pair<T, size_t>, k, HeadCompare> heads;
+    std::vector<std::unique_ptr<Run>> runs;
+    size_t buffer_capacity;
+    size_t block;
+    size_t max_runs;
+    std::string dir;
+    size_t cnt_files;
+    size_t _size;
+    Compare cmp;
+
+    std::pair<std::FILE*, std::string> open_file() {
+        if (dir.empty()) {
+            std::FILE* file = std::tmpfile();
+            if (file == nullptr) {
+                throw std::runtime_error("ExternalHeapMax: cannot create temporary file");
+            }
+            std::setvbuf(file, nullptr, _IONBF, 0);
+            return {file, std::string()};
+        }
+#ifdef EXTERNAL_HEAP_HAVE_MKSTEMP
+        std::string path = dir + "/extheap-XXXXXX";
+        int fd = ::mkstemp(&path[0]);
+        if (fd < 0) {
+            throw std::runtime_error("ExternalHeapMax: cannot create a run file in " + dir);
+        }
+        std::FILE* file = ::fdopen(fd, "w+b");
+        if (file == nullptr) {
+            ::close(fd);
+            std::remove(path.c_str());
+            throw std::runtime_error("ExternalHeapMax: cannot open " + path);
+        }
+#else
+        std::string path;
+        std::FILE* file = nullptr;
+        for (size_t attempt = 0; file == nullptr && attempt < 64; ++attempt) {
+            path = dir + "/extheap-" + std::to_string(reinterpret_cast<uintptr_t>(this)) +
+                    "-" + std::to_string(cnt_files++) + ".run";
+            file = std::fopen(path.c_str(), "w+bx");
+        }
+        if (file == nullptr) {
+            throw std::runtime_error("ExternalHeapMax: cannot create " + path);
+        }
+#endif
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        return {file, path};
+    }
+
+    template <typename Next>
+    std::unique_ptr<Run> write_run(size_t cnt, Next next) {
+        auto [file, path] = open_file();
+        try {
+            std::vector<T> chunk;
+            chunk.reserve(block);
+            for (size_t i = 0; i < cnt; ++i) {
+                chunk.push_back(next());
+                if (chunk.size() == block || i + 1 == cnt) {
+                    if (std::fwrite(chunk.data(), sizeof(T), chunk.size(), file) != chunk.size()) {
+                        throw std::runtime_error("ExternalHeapMax: short write to run file");
+                    }
+                    chunk.clear();
+                }
+            }
+        } catch (...) {
+            std::fclose(file);
+            if (!path.empty()) {
+                std::remove(path.c_str());
+            }
+            throw;
+        }
+        return std::unique_ptr<Run>(new Run(file, path, cnt, block));
+    }
+
+    void add_run(std::unique_ptr<Run> run) {
+        runs.push_back(std::move(run));
+        heads.insert({runs.back()->head(), runs.size() - 1});
+    }
+
+    void spill() {
+        if (heads.size() >= max_runs) {
+            compact_runs();
+        }
+        std::vector<T> sorted;
+        sorted.reserve(buffer.size());
+        buffer.pop_n(buffer.size(), std::back_inserter(sorted));
+        size_t i = 0;
+        std::unique_ptr<Run> run;
+        try {
+            run = write_run(sorted.size(), [&]() { return sorted[i++]; });
+        } catch (...) {
+            buffer.insert(sorted.begin(), sorted.end());
+            throw;
+        }
+        add_run(std::move(run));
+    }
+
+    void compact_runs() {
+        std::vector<size_t> active;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            if (runs[i]) {
+                active.push_back(i);
+            }
+        }
+        std::sort(active.begin(), active.end(), [this](size_t first, size_t second) {
+            return runs[first]->size() < runs[second]->size();
+        });
+        active.resize(std::min(active.size(), std::max<size_t>(2, active.size() / 2)));
+        std::vector<size_t> positions;
+        HeapKMax<std::pair<T, size_t>, k, HeadCompare> merged_heads;
+        size_t cnt = 0;
+        for (size_t i : active) {
+            cnt += runs[i]->size();
+            positions.push_back(runs[i]->position());
+            merged_heads.insert({runs[i]->head(), i});
+        }
+        std::unique_ptr<Run> run;
+        try {
+            run = write_run(cnt, [&]() {
+                auto head = merged_heads.pop();
+                if (runs[head.second]->next()) {
+                    merged_heads.insert({runs[head.second]->head(), head.second});
+                }
+                return head.first;
+            });
+        } catch (...) {
+            for (size_t j = 0; j < active.size(); ++j) {
+                runs[active[j]]->seek(positions[j]);
+            }
+            throw;
+        }
+        for (size_t i : active) {
+            runs[i].reset();
+        }
+        std::vector<std::unique_ptr<Run>> kept;
+        for (auto& other : runs) {
+            if (other) {
+                kept.push_back(std::move(other));
+            }
+        }
+        runs = std::move(kept);
+        heads = HeapKMax<std::pair<T, size_t>, k, HeadCompare>();
+        for (size_t i = 0; i < runs.size(); ++i) {
+            heads.insert({runs[i]->head(), i});
+        }
+        add_run(std::move(run));
+    }
+
+    bool max_in_buffer() const {
+        if (heads.empty()) {
+            return true;
+        }
+        if (buffer.empty()) {
+            return false;
+        }
+        return !cmp(buffer.top(), heads.top().first);
+    }
+
+public:
+    ExternalHeapMax(size_t _buffer_capacity = 1 << 20, std::string _dir = std::string(),
+            size_t _block = 1 << 16, size_t _max_runs = 64)
+        : buffer()
+        , heads()
+        , runs()
+        , buffer_capacity(std::max<size_t>(1, _buffer_capacity))
+        , block(std::max<size_t>(1, _block))
+        , max_runs(std::max<size_t>(2, _max_runs))
+        , dir(std::move(_dir))
+        , cnt_files(0)
+        , _size(0)
+        , cmp()
+    {}
+
+    ExternalHeapMax(const ExternalHeapMax&) = delete;
+    ExternalHeapMax& operator=(const ExternalHeapMax&) = delete;
+
+    void insert(const T& x) {
+        if (buffer.size() == buffer_capacity) {
+            spill();
+        }
+        buffer.insert(x);
+        ++_size;
+    }
+
+    T get_max() const {
+        return top();
+    }
+
+    const T& top() const {
+        return max_in_buffer() ? buffer.top() : heads.top().first;
+    }
+
+    void extract_max() {
+        pop();
+    }
+
+    T pop() {
+        --_size;
+        if (max_in_buffer()) {
+            return buffer.pop();
+        }
+        auto head = heads.pop();
+        if (runs[head.second]->next()) {
+            heads.insert({runs[head.second]->head(), head.second});
+        } else {
+            runs[head.second].reset();
+            if (heads.empty()) {
+                runs.clear();
+            }
+        }
+        return head.first;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    size_t runs_on_disk() const {
+        return heads.size();
+    }
+};
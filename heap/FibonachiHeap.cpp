@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <functional>
 #include <utility>
 #include <vector>
 
-template <typename T, typename Compare = std::less<T>>
-class FibonachiHeap {
+#include "HeapStats.cpp"
+
+template <typename T, typename Compare = std::less<T>, typename Stats = HeapNoStats>
+class FibonachiHeap : private Stats {
     struct Node {
         Node *left;
         Node *right;
@@ -32,12 +35,16 @@ class FibonachiHeap {
             node->data = std::forward<U>(data);
             Node* cur = node;
             if (cur->parent == nullptr) {
+                cont.update_max(node);
                 return;
             }
+            cont.tally().on_compare();
             if (Compare()(cur->data, cur->parent->data)) {
                 return;
             }
+            size_t cuts = 0;
             while (true) {
+                ++cuts;
                 Node* p = cur->parent;
                 Node* extracted = extract(cur, p->number_child);
                 p->child = cur;
@@ -54,7 +61,9 @@ class FibonachiHeap {
                 } else {
                     cur = p;
                 }
-            } 
+            }
+            cont.tally().on_cascading_cut(cuts);
+            cont.update_max(node);
         }
     };
 
@@ -63,6 +72,21 @@ class FibonachiHeap {
     size_t number_child;
     size_t _size;
 
+    Stats& tally() {
+        return *this;
+    }
+
+    void update_max(Node* node) {
+        if (cur_max == nullptr) {
+            cur_max = node;
+            return;
+        }
+        tally().on_compare();
+        if (Compare()(cur_max->data, node->data)) {
+            cur_max = node;
+        }
+    }
+
     static void del_child(Node*& child, size_t& number_child) {
         while (child->child != nullptr) {
             del_child(child->child, child->number_child);
@@ -105,8 +129,10 @@ class FibonachiHeap {
         return extracted;
     }
 
-    static Node* merge(Node* first, Node* second) {
+    static Node* merge(Node* first, Node* second, Stats& stats) {
+        stats.on_compare();
         if (!Compare()(first->data, second->data)) {
+            stats.on_swap();
             std::swap(first, second);
         }
         become_child(second->child, second->number_child, second, first);
@@ -127,15 +153,13 @@ class FibonachiHeap {
             while (!rank[i].empty()) {
                 if (rank[i].size() == 1) {
                     become_child(root, number_child, nullptr, rank[i].back());
-                    if (cur_max == nullptr || Compare()(cur_max->data, rank[i].back()->data)) {
-                        cur_max = rank[i].back();
-                    }
+                    update_max(rank[i].back());
                     rank[i].pop_back();
                 } else {
                     if (rank.size() <= i + 1) {
                         rank.emplace_back();
                     }
-                    rank[i + 1].push_back(merge(rank[i][rank[i].size() - 1], rank[i][rank[i].size() - 2]));
+                    rank[i + 1].push_back(merge(rank[i][rank[i].size() - 1], rank[i][rank[i].size() - 2], tally()));
                     rank[i].pop_back();
                     rank[i].pop_back();
                 }
@@ -145,15 +169,16 @@ class FibonachiHeap {
 
 public:
     using iterator = Iterator;
-    FibonachiHeap(): root(nullptr), cur_max(nullptr), number_child(0), _size(0) {}
+    FibonachiHeap(): Stats(), root(nullptr), cur_max(nullptr), number_child(0), _size(0) {}
 
-    FibonachiHeap(const T&) = delete;
+    FibonachiHeap(const FibonachiHeap&) = delete;
     
-    FibonachiHeap(T&& other): root(nullptr), cur_max(nullptr), number_child(0) {
+    FibonachiHeap(FibonachiHeap&& other): Stats(), root(nullptr), cur_max(nullptr), number_child(0), _size(0) {
         std::swap(root, other.root);
         std::swap(cur_max, other.cur_max);
         std::swap(number_child, other.number_child);
         std::swap(_size, other._size);
+        std::swap(tally(), other.tally());
     }
 
     FibonachiHeap& operator=(const FibonachiHeap&) = delete;
@@ -163,6 +188,7 @@ public:
         std::swap(cur_max, other.cur_max);
         std::swap(number_child, other.number_child);
         std::swap(_size, other._size);
+        std::swap(tally(), other.tally());
         return *this;
     }
 
@@ -172,21 +198,41 @@ public:
 
     template <typename U>
     iterator insert(U&& data) {
-        Node * other = new Node{nullptr, nullptr, nullptr, nullptr, 0, std::forward<U>(data), false};
+        return emplace(std::forward<U>(data));
+    }
+
+    template <typename... Args>
+    iterator emplace(Args&&... args) {
+        tally().on_allocation();
+        Node * other = new Node{nullptr, nullptr, nullptr, nullptr, 0, T(std::forward<Args>(args)...), false};
         become_child(root, number_child, nullptr, other);
-        if (cur_max == nullptr) {
-            cur_max = other;
-        } else if (Compare()(cur_max->data, other->data)) {
-            cur_max = other;
-        }
+        update_max(other);
         ++_size;
         return iterator(*this, other);
     }
 
+    template <typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first) {
+            emplace(*first);
+        }
+    }
+
     T get_max() const {
         return cur_max->data;
     }
 
+    const T& top() const {
+        return cur_max->data;
+    }
+
+    T pop() {
+        tally().on_move();
+        T result = std::move(cur_max->data);
+        extract_max();
+        return result;
+    }
+
     void extract_max() {
         Node* extracted = extract(cur_max, number_child);
         root = cur_max;
@@ -201,6 +247,44 @@ public:
         compact();
     }
 
+    template <typename Out>
+    Out pop_n(size_t n, Out out) {
+        n = std::min(n, _size);
+        if (n == 0) {
+            return out;
+        }
+        auto less = [this](Node* first, Node* second) {
+            tally().on_compare();
+            return Compare()(first->data, second->data);
+        };
+        std::vector<Node*> candidates;
+        while (root != nullptr) {
+            candidates.push_back(extract(root, number_child));
+        }
+        std::make_heap(candidates.begin(), candidates.end(), less);
+        for (size_t i = 0; i < n; ++i) {
+            std::pop_heap(candidates.begin(), candidates.end(), less);
+            Node* best = candidates.back();
+            candidates.pop_back();
+            while (best->child != nullptr) {
+                Node* node = extract(best->child, best->number_child);
+                node->mark = false;
+                candidates.push_back(node);
+                std::push_heap(candidates.begin(), candidates.end(), less);
+            }
+            tally().on_move();
+            *out++ = std::move(best->data);
+            delete best;
+        }
+        for (Node* node : candidates) {
+            become_child(root, number_child, nullptr, node);
+        }
+        _size -= n;
+        cur_max = nullptr;
+        compact();
+        return out;
+    }
+
     ~FibonachiHeap() {
         while (root != nullptr) {
             del_child(root, number_child);
@@ -210,9 +294,7 @@ public:
         while (other.root != nullptr) {
             auto extracted = extract(other.root, other.number_child);
             become_child(root, number_child, nullptr, extracted);
-            if (cur_max == nullptr || Compare()(cur_max->data, extracted->data)) {
-                cur_max = extracted;
-            }
+            update_max(extracted);
         }
         other.cur_max = nullptr;
         _size += other._size;
@@ -222,4 +304,8 @@ public:
     size_t size() const {
         return _size;
     }
+
+    const Stats& stats() const {
+        return *this;
+    }
 };
@@ -1,43 +1,165 @@
+#pragma once
+
 #include <algorithm>
 #include <vector>
 #include <functional>
+#include <utility>
+
+#include "HeapStats.cpp"
 
-template <typename T, int k, typename Compare = std::less<T>>
-class HeapKMax {
+template <typename T, int k, typename Compare = std::less<T>, typename Stats = HeapNoStats>
+class HeapKMax : private Stats {
     std::vector<T> heap;
     Compare cmp;
-public:
-    HeapKMax(): heap(), cmp() {}
 
-    void insert(const T& x) {
-        heap.push_back(x);
-        size_t i = heap.size() - 1;
-        while (i != 0 && cmp(heap[(i - 1) / k], heap[i])) {
-            std::swap(heap[(i - 1) / k], heap[i]);
-            i = (i - 1) / k;
+    Stats& tally() {
+        return *this;
+    }
+
+    bool less(const T& first, const T& second) {
+        tally().on_compare();
+        return cmp(first, second);
+    }
+
+    void swap(T& first, T& second) {
+        tally().on_swap();
+        std::swap(first, second);
+    }
+
+    void before_push() {
+        if (heap.size() == heap.capacity()) {
+            tally().on_allocation();
         }
     }
 
-    T get_max() const {
-        return heap[0];
+    void sift_up(size_t i) {
+        size_t depth = 0;
+        while (i != 0 && less(heap[(i - 1) / k], heap[i])) {
+            swap(heap[(i - 1) / k], heap[i]);
+            i = (i - 1) / k;
+            ++depth;
+        }
+        tally().on_sift_up(depth);
     }
 
-    void extract_max() {
-        std::swap(heap[0], heap.back());
-        heap.pop_back();
-        size_t i = 0;
+    size_t sink(size_t i) {
+        size_t depth = 0;
         while (true) {
             auto it = std::max_element(
                     heap.begin() + std::min(i * k + 1, heap.size()),
                     heap.begin() + std::min(i * k + k + 1, heap.size()),
-                    cmp);
-            if (it != heap.end() && cmp(heap[i], *it)) {
-                std::swap(heap[i], *it);
+                    [this](const T& first, const T& second) { return less(first, second); });
+            if (it != heap.end() && less(heap[i], *it)) {
+                swap(heap[i], *it);
                 i = it - heap.begin();
+                ++depth;
             } else {
                 break;
             }
         }
+        return depth;
+    }
+
+    void sift_down(size_t i) {
+        tally().on_sift_down(sink(i));
+    }
+
+    void heapify() {
+        if (heap.size() < 2) {
+            return;
+        }
+        for (size_t i = (heap.size() - 2) / k + 1; i-- > 0;) {
+            sink(i);
+        }
+    }
+
+public:
+    HeapKMax(): Stats(), heap(), cmp() {}
+
+    void insert(const T& x) {
+        before_push();
+        heap.push_back(x);
+        sift_up(heap.size() - 1);
+    }
+
+    void insert(T&& x) {
+        before_push();
+        tally().on_move();
+        heap.push_back(std::move(x));
+        sift_up(heap.size() - 1);
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        before_push();
+        heap.emplace_back(std::forward<Args>(args)...);
+        sift_up(heap.size() - 1);
+    }
+
+    template <typename It>
+    void insert(It first, It last) {
+        size_t old_size = heap.size();
+        for (; first != last; ++first) {
+            before_push();
+            heap.push_back(*first);
+        }
+        if (heap.size() - old_size > old_size) {
+            heapify();
+        } else {
+            for (size_t i = old_size; i < heap.size(); ++i) {
+                sift_up(i);
+            }
+        }
+    }
+
+    T get_max() const {
+        return heap[0];
+    }
+
+    const T& top() const {
+        return heap[0];
+    }
+
+    void extract_max() {
+        swap(heap[0], heap.back());
+        heap.pop_back();
+        sift_down(0);
+    }
+
+    T pop() {
+        swap(heap[0], heap.back());
+        tally().on_move();
+        T result = std::move(heap.back());
+        heap.pop_back();
+        sift_down(0);
+        return result;
+    }
+
+    template <typename Out>
+    Out pop_n(size_t n, Out out) {
+        n = std::min(n, heap.size());
+        size_t log_size = 1;
+        while ((size_t(1) << log_size) < heap.size()) {
+            ++log_size;
+        }
+        if (n * log_size < heap.size()) {
+            for (size_t i = 0; i < n; ++i) {
+                *out++ = pop();
+            }
+            return out;
+        }
+        auto greater = [this](const T& first, const T& second) { return less(second, first); };
+        if (n < heap.size()) {
+            std::nth_element(heap.begin(), heap.begin() + n, heap.end(), greater);
+        }
+        std::sort(heap.begin(), heap.begin() + n, greater);
+        for (size_t i = 0; i < n; ++i) {
+            tally().on_move();
+            *out++ = std::move(heap[i]);
+        }
+        heap.erase(heap.begin(), heap.begin() + n);
+        heapify();
+        return out;
     }
 
     bool empty() const {
@@ -47,4 +169,8 @@ public:
     size_t size() const {
         return heap.size();
     }
+
+    const Stats& stats() const {
+        return *this;
+    }
 };
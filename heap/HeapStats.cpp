@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct HeapNoStats {
+    static constexpr bool enabled = false;
+
+    void on_compare() {}
+    void on_swap() {}
+    void on_move() {}
+    void on_allocation() {}
+    void on_sift_up(size_t) {}
+    void on_sift_down(size_t) {}
+    void on_carry_chain(size_t) {}
+    void on_cascading_cut(size_t) {}
+};
+
+class HeapHistogram {
+    std::vector<size_t> counts;
+    size_t total;
+
+public:
+    HeapHistogram(): counts(), total(0) {}
+
+    void add(size_t value) {
+        if (counts.size() <= value) {
+            counts.resize(value + 1);
+        }
+        ++counts[value];
+        ++total;
+    }
+
+    size_t operator[](size_t value) const {
+        return value < counts.size() ? counts[value] : 0;
+    }
+
+    size_t size() const {
+        return counts.size();
+    }
+
+    size_t samples() const {
+        return total;
+    }
+
+    double mean() const {
+        size_t sum = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            sum += i * counts[i];
+        }
+        return total == 0 ? 0 : static_cast<double>(sum) / total;
+    }
+};
+
+struct HeapStats {
+    static constexpr bool enabled = true;
+
+    size_t comparisons = 0;
+    size_t swaps = 0;
+    size_t moves = 0;
+    size_t allocations = 0;
+    HeapHistogram sift_up_depth;
+    HeapHistogram sift_down_depth;
+    HeapHistogram carry_chain;
+    HeapHistogram cascading_cut;
+
+    void on_compare() { ++comparisons; }
+    void on_swap() { ++swaps; }
+    void on_move() { ++moves; }
+    void on_allocation() { ++allocations; }
+    void on_sift_up(size_t depth) { sift_up_depth.add(depth); }
+    void on_sift_down(size_t depth) { sift_down_depth.add(depth); }
+    void on_carry_chain(size_t length) { carry_chain.add(length); }
+    void on_cascading_cut(size_t length) { cascading_cut.add(length); }
+};
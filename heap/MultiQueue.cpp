@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "HeapK.cpp"
+
+template <typename T, int k = 4, typename Compare = std::less<T>>
+class MultiQueue {
+    struct alignas(64) Shard {
+        std::atomic_flag locked = ATOMIC_FLAG_INIT;
+        HeapKMax<T, k, Compare> heap;
+
+        bool try_lock() {
+            return !locked.test_and_set(std::memory_order_acquire);
+        }
+
+        void lock() {
+            while (locked.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            locked.clear(std::memory_order_release);
+        }
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t cnt_shards;
+    bool strict;
+    Compare cmp;
+    std::atomic<size_t> _size;
+
+    static size_t random() {
+        thread_local std::minstd_rand gen(
+                std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return gen();
+    }
+
+    size_t random_shard() const {
+        return random() % cnt_shards;
+    }
+
+    class LockAll {
+        Shard* first;
+        Shard* last;
+
+    public:
+        LockAll(Shard* _first, Shard* _last): first(_first), last(_last) {
+            for (Shard* shard = first; shard != last; ++shard) {
+                shard->lock();
+            }
+        }
+
+        LockAll(const LockAll&) = delete;
+        LockAll& operator=(const LockAll&) = delete;
+
+        ~LockAll() {
+            for (Shard* shard = first; shard != last; ++shard) {
+                shard->unlock();
+            }
+        }
+    };
+
+    bool extract_from(Shard& shard, T& result) {
+        result = shard.heap.pop();
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool extract_exact(T& result) {
+        LockAll all(shards.get(), shards.get() + cnt_shards);
+        Shard* best = nullptr;
+        for (size_t i = 0; i < cnt_shards; ++i) {
+            if (!shards[i].heap.empty() &&
+                    (best == nullptr || cmp(best->heap.top(), shards[i].heap.top()))) {
+                best = &shards[i];
+            }
+        }
+        if (best == nullptr) {
+            return false;
+        }
+        return extract_from(*best, result);
+    }
+
+public:
+    MultiQueue(size_t threads = std::thread::hardware_concurrency(), size_t c = 2, bool _strict = false)
+        : shards()
+        , cnt_shards(std::max<size_t>(1, c * std::max<size_t>(1, threads)))
+        , strict(_strict)
+        , cmp()
+        , _size(0)
+    {
+        shards.reset(new Shard[cnt_shards]);
+    }
+
+    MultiQueue(const MultiQueue&) = delete;
+    MultiQueue& operator=(const MultiQueue&) = delete;
+
+    void insert(const T& x) {
+        emplace(x);
+    }
+
+    void insert(T&& x) {
+        emplace(std::move(x));
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        _size.fetch_add(1, std::memory_order_relaxed);
+        try {
+            while (true) {
+                std::unique_lock<Shard> guard(shards[random_shard()], std::try_to_lock);
+                if (guard.owns_lock()) {
+                    guard.mutex()->heap.emplace(std::forward<Args>(args)...);
+                    break;
+                }
+            }
+        } catch (...) {
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    bool try_extract_max(T& result) {
+        if (strict || cnt_shards == 1) {
+            return extract_exact(result);
+        }
+        for (size_t attempt = 0; attempt < 2 * cnt_shards; ++attempt) {
+            if (empty()) {
+                return false;
+            }
+            std::unique_lock<Shard> first(shards[random_shard()], std::try_to_lock);
+            if (!first.owns_lock()) {
+                continue;
+            }
+            Shard& one = *first.mutex();
+            std::unique_lock<Shard> second(shards[random_shard()], std::defer_lock);
+            if (second.mutex() == &one || !second.try_lock()) {
+                if (one.heap.empty()) {
+                    continue;
+                }
+                return extract_from(one, result);
+            }
+            Shard& other = *second.mutex();
+            if (one.heap.empty() && other.heap.empty()) {
+                continue;
+            }
+            if (other.heap.empty() || (!one.heap.empty() && !cmp(one.heap.top(), other.heap.top()))) {
+                second.unlock();
+                return extract_from(one, result);
+            }
+            first.unlock();
+            return extract_from(other, result);
+        }
+        return extract_exact(result);
+    }
+
+    bool empty() const {
+        return _size.load(std::memory_order_relaxed) == 0;
+    }
+
+    size_t size() const {
+        return _size.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,120 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+struct RadixKey {
+    static T key(const T& x) {
+        return x;
+    }
+};
+
+template <typename Key, typename Value>
+struct RadixKey<std::pair<Key, Value>> {
+    static Key key(const std::pair<Key, Value>& x) {
+        return x.first;
+    }
+};
+
+template <typename T, typename KeyOf = RadixKey<T>>
+class RadixHeapMin {
+    using Key = decltype(KeyOf::key(std::declval<const T&>()));
+    static_assert(std::is_unsigned<Key>::value, "RadixHeapMin needs unsigned integer keys");
+    static constexpr size_t cnt_buckets = std::numeric_limits<Key>::digits + 1;
+
+    mutable std::vector<std::vector<T>> buckets;
+    mutable Key last;
+    size_t _size;
+
+    static size_t bucket_index(Key x, Key last) {
+        if (x == last) {
+            return 0;
+        }
+        uint64_t diff = static_cast<uint64_t>(x ^ last);
+#if defined(__GNUC__)
+        return 64 - __builtin_clzll(diff);
+#else
+        size_t i = 0;
+        for (; diff != 0; diff >>= 1) {
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    void redistribute() const {
+        if (!buckets[0].empty()) {
+            return;
+        }
+        size_t i = 1;
+        while (buckets[i].empty()) {
+            ++i;
+        }
+        auto& from = buckets[i];
+        last = KeyOf::key(from[0]);
+        for (size_t j = 1; j < from.size(); ++j) {
+            if (KeyOf::key(from[j]) < last) {
+                last = KeyOf::key(from[j]);
+            }
+        }
+        for (auto& x : from) {
+            buckets[bucket_index(KeyOf::key(x), last)].push_back(std::move(x));
+        }
+        from.clear();
+    }
+
+public:
+    RadixHeapMin(): buckets(cnt_buckets), last(0), _size(0) {}
+
+    void insert(const T& x) {
+        assert(!(KeyOf::key(x) < last) && "RadixHeapMin keys must not go below the current minimum");
+        buckets[bucket_index(KeyOf::key(x), last)].push_back(x);
+        ++_size;
+    }
+
+    void insert(T&& x) {
+        assert(!(KeyOf::key(x) < last) && "RadixHeapMin keys must not go below the current minimum");
+        size_t i = bucket_index(KeyOf::key(x), last);
+        buckets[i].push_back(std::move(x));
+        ++_size;
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        insert(T(std::forward<Args>(args)...));
+    }
+
+    const T& get_min() const {
+        redistribute();
+        return buckets[0].back();
+    }
+
+    const T& top() const {
+        return get_min();
+    }
+
+    T pop() {
+        redistribute();
+        T result = std::move(buckets[0].back());
+        extract_min();
+        return result;
+    }
+
+    void extract_min() {
+        redistribute();
+        buckets[0].pop_back();
+        --_size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+};
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include <utility>
+
+template <typename T, int k = 4, typename Compare = std::less<T>>
+class TopK {
+    std::vector<T> heap;
+    size_t capacity;
+    Compare cmp;
+
+    void sift_up(size_t i) {
+        while (i != 0 && cmp(heap[i], heap[(i - 1) / k])) {
+            std::swap(heap[(i - 1) / k], heap[i]);
+            i = (i - 1) / k;
+        }
+    }
+
+    void sift_down(size_t i, size_t n) {
+        while (true) {
+            auto it = std::min_element(
+                    heap.begin() + std::min(i * k + 1, n),
+                    heap.begin() + std::min(i * k + k + 1, n),
+                    cmp);
+            if (it != heap.begin() + std::min(i * k + k + 1, n) && cmp(*it, heap[i])) {
+                std::swap(heap[i], *it);
+                i = it - heap.begin();
+            } else {
+                break;
+            }
+        }
+    }
+
+    void make_heap() {
+        if (heap.size() < 2) {
+            return;
+        }
+        for (size_t i = (heap.size() - 2) / k + 1; i-- > 0;) {
+            sift_down(i, heap.size());
+        }
+    }
+
+    template <typename U>
+    void replace_min(U&& x) {
+        heap[0] = std::forward<U>(x);
+        sift_down(0, heap.size());
+    }
+
+public:
+    TopK(size_t K): heap(), capacity(K), cmp() {
+        heap.reserve(K);
+    }
+
+    void offer(const T& x) {
+        if (heap.size() < capacity) {
+            heap.push_back(x);
+            sift_up(heap.size() - 1);
+        } else if (capacity != 0 && cmp(heap[0], x)) {
+            replace_min(x);
+        }
+    }
+
+    void offer(T&& x) {
+        if (heap.size() < capacity) {
+            heap.push_back(std::move(x));
+            sift_up(heap.size() - 1);
+        } else if (capacity != 0 && cmp(heap[0], x)) {
+            replace_min(std::move(x));
+        }
+    }
+
+    template <typename It>
+    void offer(It first, It last) {
+        if (heap.size() < capacity) {
+            bool was_empty = heap.empty();
+            for (; first != last && heap.size() < capacity; ++first) {
+                heap.push_back(*first);
+                if (!was_empty) {
+                    sift_up(heap.size() - 1);
+                }
+            }
+            if (was_empty) {
+                make_heap();
+            }
+        }
+        if (capacity == 0) {
+            return;
+        }
+        for (; first != last; ++first) {
+            if (cmp(heap[0], *first)) {
+                replace_min(*first);
+            }
+        }
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        offer(T(std::forward<Args>(args)...));
+    }
+
+    const T& get_min() const {
+        return heap[0];
+    }
+
+    const T& top() const {
+        return heap[0];
+    }
+
+    T pop() {
+        T result = std::move(heap[0]);
+        heap[0] = std::move(heap.back());
+        heap.pop_back();
+        sift_down(0, heap.size());
+        return result;
+    }
+
+    std::vector<T> extract_sorted() {
+        for (size_t n = heap.size(); n > 1; --n) {
+            std::swap(heap[0], heap[n - 1]);
+            sift_down(0, n - 1);
+        }
+        std::vector<T> result;
+        std::swap(result, heap);
+        heap.reserve(capacity);
+        return result;
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+};
@@ -1,11 +1,128 @@
 #include <vector>
 #include <iostream>
+#include <fstream>
 #include <utility>
 #include <iterator>
 #include <algorithm>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+struct BPlusTreeNoCounters {
+    static constexpr bool enabled = false;
+
+    void on_descent() {}
+    void on_visit() {}
+    void on_compare() {}
+    void on_insert() {}
+    void on_erase() {}
+    void on_split() {}
+    void on_root_split() {}
+    void on_merge() {}
+    void on_borrow() {}
+    void on_root_collapse() {}
+    void on_learned_hit() {}
+    void on_learned_miss() {}
+};
+
+struct BPlusTreeCounters {
+    static constexpr bool enabled = true;
+
+    size_t descents = 0;
+    size_t nodes_visited = 0;
+    size_t comparisons = 0;
+    size_t inserts = 0;
+    size_t erases = 0;
+    size_t splits = 0;
+    size_t root_splits = 0;
+    size_t merges = 0;
+    size_t borrows = 0;
+    size_t root_collapses = 0;
+    size_t learned_hits = 0;
+    size_t learned_misses = 0;
+
+    void on_descent() { ++descents; }
+    void on_visit() { ++nodes_visited; }
+    void on_compare() { ++comparisons; }
+    void on_insert() { ++inserts; }
+    void on_erase() { ++erases; }
+    void on_split() { ++splits; }
+    void on_root_split() { ++root_splits; }
+    void on_merge() { ++merges; }
+    void on_borrow() { ++borrows; }
+    void on_root_collapse() { ++root_collapses; }
+    void on_learned_hit() { ++learned_hits; }
+    void on_learned_miss() { ++learned_misses; }
+};
+
+struct BPlusTreeStats {
+    size_t size;
+    size_t height;
+    size_t leaves;
+    size_t inner_nodes;
+    size_t min_children;
+    size_t max_children;
+    double average_children;
+    double fill_ratio;
+    size_t bytes;
+    double bytes_per_key;
+};
+
+template <typename T>
+struct BPlusTreeSerializer {
+    static_assert(std::is_trivially_copyable<T>::value, "BPlusTreeSerializer needs a specialization for this key type");
+
+    static constexpr uint32_t width = sizeof(T);
+
+    static void write(std::vector<char>& out, const T& data) {
+        const char* bytes = reinterpret_cast<const char*>(&data);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static T read(const char*& in, const char* end) {
+        if (static_cast<size_t>(end - in) < sizeof(T)) {
+            throw std::runtime_error("BPlusTree: truncated key in checkpoint");
+        }
+        T data;
+        std::memcpy(&data, in, sizeof(T));
+        in += sizeof(T);
+        return data;
+    }
+};
+
+template <>
+struct BPlusTreeSerializer<std::string> {
+    static constexpr uint32_t width = 0;
+
+    static void write(std::vector<char>& out, const std::string& data) {
+        uint64_t length = data.size();
+        const char* bytes = reinterpret_cast<const char*>(&length);
+        out.insert(out.end(), bytes, bytes + sizeof(length));
+        out.insert(out.end(), data.begin(), data.end());
+    }
+
+    static std::string read(const char*& in, const char* end) {
+        uint64_t length;
+        if (static_cast<size_t>(end - in) < sizeof(length)) {
+            throw std::runtime_error("BPlusTree: truncated key in checkpoint");
+        }
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if (static_cast<uint64_t>(end - in) < length) {
+            throw std::runtime_error("BPlusTree: truncated key in checkpoint");
+        }
+        std::string data(in, length);
+        in += length;
+        return data;
+    }
+};
 
-template <typename T, unsigned int k = 2, typename Compare = std::less<T>>
+template <typename T, unsigned int k = 2, typename Compare = std::less<T>, typename Counters = BPlusTreeNoCounters>
 class BPlusTree {
     enum TYPE_FIND {FIND, LOWER_BOUND, UPPER_BOUND};
     class Node;
@@ -14,6 +131,7 @@ class BPlusTree {
     class Leaf;
     class Usual;
     class Root;
+    class LearnedIndex;
     template <typename> class Iterator;
 
 public:
@@ -27,40 +145,44 @@ private:
         virtual const Leaf* max_leaf() const = 0;
         virtual Leaf* max_leaf() = 0;
 
-        virtual const Leaf* find_next(const T&, const TYPE_FIND type_find) const = 0;
-        virtual Leaf* find_next(const T&, const TYPE_FIND type_find) = 0;
+        virtual const Leaf* find_next(const T&, const TYPE_FIND type_find, Counters&) const = 0;
+        virtual Leaf* find_next(const T&, const TYPE_FIND type_find, Counters&) = 0;
 
-        virtual const Leaf* find_deep(const T&, const TYPE_FIND type_find) const = 0;
-        virtual Leaf* find_deep(const T&, const TYPE_FIND type_find) = 0;
+        virtual const Leaf* find_deep(const T&, const TYPE_FIND type_find, Counters&) const = 0;
+        virtual Leaf* find_deep(const T&, const TYPE_FIND type_find, Counters&) = 0;
 
-        const Leaf* find(const T& other_data, const TYPE_FIND type_find) const {
+        const Leaf* find(const T& other_data, const TYPE_FIND type_find, Counters& counters) const {
+            counters.on_visit();
+            counters.on_compare();
             if (type_find != UPPER_BOUND) {
                 if (Compare()(max_leaf()->data, other_data)) {
-                    return find_next(other_data, type_find);
+                    return find_next(other_data, type_find, counters);
                 } else {
-                    return find_deep(other_data, type_find);
+                    return find_deep(other_data, type_find, counters);
                 }
             } else {
                 if (!Compare()(other_data, max_leaf()->data)) {
-                    return find_next(other_data, type_find);
+                    return find_next(other_data, type_find, counters);
                 } else {
-                    return find_deep(other_data, type_find);
+                    return find_deep(other_data, type_find, counters);
                 }
             }
         }
 
-        Leaf* find(const T& other_data, const TYPE_FIND type_find) {
+        Leaf* find(const T& other_data, const TYPE_FIND type_find, Counters& counters) {
+            counters.on_visit();
+            counters.on_compare();
             if (type_find != UPPER_BOUND) {
                 if (Compare()(max_leaf()->data, other_data)) {
-                    return find_next(other_data, type_find);
+                    return find_next(other_data, type_find, counters);
                 } else {
-                    return find_deep(other_data, type_find);
+                    return find_deep(other_data, type_find, counters);
                 }
             } else {
                 if (!Compare()(other_data, max_leaf()->data)) {
-                    return find_next(other_data, type_find);
+                    return find_next(other_data, type_find, counters);
                 } else {
-                    return find_deep(other_data, type_find);
+                    return find_deep(other_data, type_find, counters);
                 }
             }
         }
@@ -74,12 +196,12 @@ private:
 
         Child(): Node(), parent(nullptr), left(nullptr), right(nullptr) {}
 
-        const Leaf* find_next(const T& other_data, const TYPE_FIND type_find) const override {
-            return right->Node::find(other_data, type_find);
+        const Leaf* find_next(const T& other_data, const TYPE_FIND type_find, Counters& counters) const override {
+            return right->Node::find(other_data, type_find, counters);
         }
 
-        Leaf* find_next(const T& other_data, const TYPE_FIND type_find) override {
-            return right->Node::find(other_data, type_find);
+        Leaf* find_next(const T& other_data, const TYPE_FIND type_find, Counters& counters) override {
+            return right->Node::find(other_data, type_find, counters);
         }
 
         void set_parent(Parent* new_parent) {
@@ -129,8 +251,9 @@ private:
                 tmp = parent->child;
                 parent->child = right;
             }
-            if (parent->last_child == this) {
-                parent->set_last_child(left);
+            bool was_last = parent->last_child == this;
+            if (was_last) {
+                parent->last_child = left;
             }
             --parent->cnt_child;
             if (right) {
@@ -140,6 +263,9 @@ private:
                 tmp = left->right;
                 left->right = right;
             }
+            if (was_last) {
+                tmp->parent->update();
+            }
             tmp->parent->check();
         }
     };
@@ -151,14 +277,20 @@ private:
         template <typename U>
         Leaf(U&& d): Child(), data(std::forward<U>(d)) {}
 
-        const Leaf* find_deep(const T& other_data, const TYPE_FIND type_find) const override {
+        const Leaf* find_deep(const T& other_data, const TYPE_FIND type_find, Counters& counters) const override {
+            if (type_find == FIND) {
+                counters.on_compare();
+            }
             if (type_find == FIND && Compare()(other_data, data)) {
                 return (nullptr);
             }
             return (this);
         }
 
-        Leaf* find_deep(const T& other_data, const TYPE_FIND type_find) override {
+        Leaf* find_deep(const T& other_data, const TYPE_FIND type_find, Counters& counters) override {
+            if (type_find == FIND) {
+                counters.on_compare();
+            }
             if (type_find == FIND && Compare()(other_data, data)) {
                 return (nullptr);
             }
@@ -194,12 +326,12 @@ private:
         }
             
 
-        const Leaf* find_deep(const T& other_data, const TYPE_FIND type_find) const override {
-            return child->find(other_data, type_find);
+        const Leaf* find_deep(const T& other_data, const TYPE_FIND type_find, Counters& counters) const override {
+            return child->find(other_data, type_find, counters);
         }
 
-        Leaf* find_deep(const T& other_data, const TYPE_FIND type_find) override {
-            return child->find(other_data, type_find);
+        Leaf* find_deep(const T& other_data, const TYPE_FIND type_find, Counters& counters) override {
+            return child->find(other_data, type_find, counters);
         }
 
         const Leaf* max_leaf() const override {
@@ -220,14 +352,23 @@ private:
             _max_leaf = last_child->max_leaf();
         }
         virtual void check() = 0;
+        virtual Counters& counters() = 0;
     };
 
     class Usual : public Child, public Parent {
     public:
         Usual(): Node(), Child(), Parent() {}
 
+        Counters& counters() override {
+            return Child::parent->counters();
+        }
+
         void split() override {
-            if (Parent::cnt_child == 2 * k) { std::shared_ptr<Usual> new_parent(new Usual());
+            if (Parent::cnt_child == 2 * k) {
+                if constexpr (Counters::enabled) {
+                    counters().on_split();
+                }
+                std::shared_ptr<Usual> new_parent = std::make_shared<Usual>();
                 Child* mid = Parent::child.get();
                 for (size_t i = 0; i < k; ++i) {
                     mid = mid->right.get();
@@ -247,6 +388,13 @@ private:
 
         void check() override {
             if (Parent::cnt_child < k) {
+                if constexpr (Counters::enabled) {
+                    if (Child::right || Child::left != nullptr) {
+                        bool merge = (Child::right ? static_cast<Usual*>(Child::right.get())->cnt_child
+                                : static_cast<Usual*>(Child::left)->cnt_child) == k;
+                        merge ? counters().on_merge() : counters().on_borrow();
+                    }
+                }
                 if (Child::right) {
                     auto v = static_cast<Usual*>(Child::right.get());
                     if (v->cnt_child == k) {
@@ -256,16 +404,20 @@ private:
                         Parent::set_last_child(v->child.get());
                         v->child->set_parent(this);
                         v->child = v->child->right;
+                        update();
                     }
                 } else if (Child::left != nullptr) {
                     auto v = static_cast<Usual*>(Child::left);
                     if (v->cnt_child == k) {
                         v->set_children(v->child, Parent::last_child);
+                        v->update();
                         Child::erase();
                     } else {
-                        v->last_child->set_parent(this);
-                        v->set_last_child(Child::left);
+                        Child* moved = v->last_child;
+                        moved->set_parent(this);
+                        v->set_last_child(moved->left);
                         Parent::child = v->last_child->right;
+                        v->update();
                     }
                 } else {
                     if (Parent::cnt_child == 1) {
@@ -278,32 +430,255 @@ private:
 
     class Root : public Parent {
     public:
-        Root(): Parent() {}
+        mutable Counters _counters;
 
-        const Leaf* find_next(const T&, const TYPE_FIND) const {
+        Root(): Parent(), _counters() {}
+
+        Counters& counters() override {
+            return _counters;
+        }
+
+        const Leaf* find_next(const T&, const TYPE_FIND, Counters&) const override {
             return (nullptr);
         }
 
-        Leaf* find_next(const T&, const TYPE_FIND) {
+        Leaf* find_next(const T&, const TYPE_FIND, Counters&) override {
             return (nullptr);
         }
 
         void split() override {
             if (Parent::cnt_child == 2) {
-                std::shared_ptr<Usual> new_parent(new Usual());
+                _counters.on_root_split();
+                std::shared_ptr<Usual> new_parent = std::make_shared<Usual>();
                 new_parent->set_children(Parent::child, Parent::last_child);
                 Parent::set_children(new_parent, new_parent.get());
             }
         }
 
         void check() override {
+            _counters.on_root_collapse();
             std::shared_ptr<Child> died = Parent::child;
+            --Parent::cnt_child;
             Parent::set_children(static_cast<Usual*>(died.get())->child, static_cast<Usual*>(died.get())->last_child);
         }
     };
             
 
 
+    class LearnedIndex {
+        struct Segment {
+            double slope;
+            size_t drift;
+            std::vector<T> keys;
+            std::vector<Leaf*> leaves;
+        };
+
+        size_t epsilon;
+        size_t capacity;
+        std::vector<T> firsts;
+        std::vector<Segment> segments;
+        std::vector<size_t> stale;
+
+        static double offset(const T& data, const T& base) {
+            if (!Compare()(base, data)) {
+                return 0;
+            }
+            if constexpr (std::is_integral<T>::value) {
+                using U = typename std::make_unsigned<T>::type;
+                return static_cast<double>(static_cast<U>(data) - static_cast<U>(base));
+            } else {
+                return static_cast<double>(data - base);
+            }
+        }
+
+        void fit(const std::vector<T>& keys, const std::vector<Leaf*>& leaves,
+                std::vector<T>& new_firsts, std::vector<Segment>& new_segments) const {
+            size_t i = 0;
+            while (i < keys.size()) {
+                const T base = keys[i];
+                size_t from = i;
+                double lo = 0;
+                double hi = std::numeric_limits<double>::infinity();
+                for (; i < keys.size() && i - from < capacity; ++i) {
+                    double pos = static_cast<double>(i - from);
+                    double dx = offset(keys[i], base);
+                    if (dx == 0) {
+                        if (pos > epsilon) {
+                            break;
+                        }
+                        continue;
+                    }
+                    double new_lo = std::max(lo, (pos - epsilon) / dx);
+                    double new_hi = std::min(hi, (pos + epsilon) / dx);
+                    if (new_lo > new_hi) {
+                        break;
+                    }
+                    lo = new_lo;
+                    hi = new_hi;
+                }
+                double slope = hi == std::numeric_limits<double>::infinity() ? 0 : (lo + hi) / 2;
+                new_firsts.push_back(base);
+                new_segments.push_back(Segment{slope, 0, std::vector<T>(keys.begin() + from, keys.begin() + i),
+                        std::vector<Leaf*>(leaves.begin() + from, leaves.begin() + i)});
+            }
+        }
+
+        size_t segment_of(const T& data, bool upper) const {
+            auto it = upper ? std::upper_bound(firsts.begin(), firsts.end(), data, Compare())
+                    : std::lower_bound(firsts.begin(), firsts.end(), data, Compare());
+            return it == firsts.begin() ? 0 : it - firsts.begin() - 1;
+        }
+
+        bool before(const T& key, const T& data, bool upper) const {
+            return upper ? !Compare()(data, key) : Compare()(key, data);
+        }
+
+        void touch(size_t s) {
+            Segment& segment = segments[s];
+            ++segment.drift;
+            if (segment.drift > epsilon || segment.keys.empty() || segment.keys.size() > 2 * capacity) {
+                stale.push_back(s);
+            }
+        }
+
+        void refit(size_t s) {
+            std::vector<T> new_firsts;
+            std::vector<Segment> new_segments;
+            fit(segments[s].keys, segments[s].leaves, new_firsts, new_segments);
+            if (new_segments.empty()) {
+                firsts.erase(firsts.begin() + s);
+                segments.erase(segments.begin() + s);
+                return;
+            }
+            firsts[s] = new_firsts[0];
+            segments[s] = std::move(new_segments[0]);
+            firsts.insert(firsts.begin() + s + 1, new_firsts.begin() + 1, new_firsts.end());
+            segments.insert(segments.begin() + s + 1, std::make_move_iterator(new_segments.begin() + 1),
+                    std::make_move_iterator(new_segments.end()));
+        }
+
+    public:
+        LearnedIndex(size_t _epsilon)
+            : epsilon(_epsilon)
+            , capacity(64 * std::max<size_t>(1, _epsilon))
+            , firsts()
+            , segments()
+            , stale()
+        {}
+
+        void rebuild(Leaf* first) {
+            std::vector<T> keys;
+            std::vector<Leaf*> leaves;
+            for (Leaf* v = first; v != nullptr; v = static_cast<Leaf*>(v->right.get())) {
+                keys.push_back(v->data);
+                leaves.push_back(v);
+            }
+            clear();
+            fit(keys, leaves, firsts, segments);
+        }
+
+        void clear() {
+            firsts.clear();
+            segments.clear();
+            stale.clear();
+        }
+
+        size_t size() const {
+            return segments.size();
+        }
+
+        size_t bytes() const {
+            size_t result = sizeof(LearnedIndex) + firsts.capacity() * sizeof(T)
+                    + segments.capacity() * sizeof(Segment) + stale.capacity() * sizeof(size_t);
+            for (const Segment& segment : segments) {
+                result += segment.keys.capacity() * sizeof(T) + segment.leaves.capacity() * sizeof(Leaf*);
+            }
+            return result;
+        }
+
+        bool find(const T& data, const TYPE_FIND type_find, Leaf*& result) const {
+            if (segments.empty()) {
+                return false;
+            }
+            bool upper = type_find == UPPER_BOUND;
+            size_t s = segment_of(data, upper);
+            const Segment& segment = segments[s];
+            size_t cnt = segment.keys.size();
+            if (cnt == 0) {
+                return false;
+            }
+            double predicted = segment.slope * offset(data, firsts[s]);
+            size_t pos = predicted < cnt ? static_cast<size_t>(predicted) : cnt;
+            size_t window = epsilon + segment.drift + 1;
+            size_t lo = pos > window ? pos - window : 0;
+            size_t hi = std::min(cnt, pos + window + 1);
+            auto bound = [&](size_t from, size_t to) {
+                auto first = segment.keys.begin() + from;
+                auto last = segment.keys.begin() + to;
+                return static_cast<size_t>((upper ? std::upper_bound(first, last, data, Compare())
+                        : std::lower_bound(first, last, data, Compare())) - segment.keys.begin());
+            };
+            size_t i = bound(lo, hi);
+            if ((i != 0 && !before(segment.keys[i - 1], data, upper)) || (i != cnt && before(segment.keys[i], data, upper))) {
+                i = bound(0, cnt);
+            }
+            Leaf* leaf = i != cnt ? segment.leaves[i] : static_cast<Leaf*>(segment.leaves.back()->right.get());
+            if (type_find == FIND && leaf != nullptr && Compare()(data, leaf->data)) {
+                leaf = nullptr;
+            }
+            result = leaf;
+            return true;
+        }
+
+        void insert(Leaf* leaf) {
+            if (segments.empty()) {
+                return;
+            }
+            size_t s = segment_of(leaf->data, false);
+            Segment& segment = segments[s];
+            size_t i = std::lower_bound(segment.keys.begin(), segment.keys.end(), leaf->data, Compare()) - segment.keys.begin();
+            segment.keys.insert(segment.keys.begin() + i, leaf->data);
+            segment.leaves.insert(segment.leaves.begin() + i, leaf);
+            touch(s);
+        }
+
+        void erase(const Leaf* leaf) {
+            if (segments.empty()) {
+                return;
+            }
+            size_t to = segment_of(leaf->data, true);
+            for (size_t s = segment_of(leaf->data, false); s <= to; ++s) {
+                Segment& segment = segments[s];
+                auto range = std::equal_range(segment.keys.begin(), segment.keys.end(), leaf->data, Compare());
+                for (auto it = range.first; it != range.second; ++it) {
+                    size_t i = it - segment.keys.begin();
+                    if (segment.leaves[i] == leaf) {
+                        segment.keys.erase(it);
+                        segment.leaves.erase(segment.leaves.begin() + i);
+                        touch(s);
+                        return;
+                    }
+                }
+            }
+        }
+
+        void maintain(Leaf* first) {
+            if (segments.empty()) {
+                rebuild(first);
+                return;
+            }
+            std::sort(stale.begin(), stale.end());
+            stale.erase(std::unique(stale.begin(), stale.end()), stale.end());
+            for (auto it = stale.rbegin(); it != stale.rend(); ++it) {
+                refit(*it);
+            }
+            stale.clear();
+            if (segments.empty()) {
+                rebuild(first);
+            }
+        }
+    };
+
     template <typename U>
     class Iterator {
     public:
@@ -340,19 +715,157 @@ private:
 
     };
 
+    static constexpr bool learnable = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value
+            && std::is_same<Compare, std::less<T>>::value;
+
     std::shared_ptr<Root> root;
     Leaf* first;
     size_t _size;
+    std::unique_ptr<LearnedIndex> learned;
+
+    const Leaf* descend(const T& data, const TYPE_FIND type_find) const {
+        if constexpr (learnable) {
+            if (learned) {
+                Leaf* leaf;
+                if (learned->find(data, type_find, leaf)) {
+                    root->_counters.on_learned_hit();
+                    return leaf;
+                }
+                root->_counters.on_learned_miss();
+            }
+        }
+        root->_counters.on_descent();
+        return root->find(data, type_find, root->_counters);
+    }
+
+    Leaf* descend(const T& data, const TYPE_FIND type_find) {
+        if constexpr (learnable) {
+            if (learned) {
+                Leaf* leaf;
+                if (learned->find(data, type_find, leaf)) {
+                    root->_counters.on_learned_hit();
+                    return leaf;
+                }
+                root->_counters.on_learned_miss();
+            }
+        }
+        root->_counters.on_descent();
+        return root->find(data, type_find, root->_counters);
+    }
+
+    void learned_insert(Leaf* leaf) {
+        if constexpr (learnable) {
+            if (learned) {
+                learned->insert(leaf);
+            }
+        }
+    }
+
+    void learned_erase(const Leaf* leaf) {
+        if constexpr (learnable) {
+            if (learned) {
+                learned->erase(leaf);
+            }
+        }
+    }
+
+    void learned_maintain() {
+        if constexpr (learnable) {
+            if (learned) {
+                learned->maintain(first);
+            }
+        }
+    }
+
+    static size_t node_bytes(size_t object) {
+        size_t align = alignof(std::max_align_t);
+        size_t block = object + 2 * sizeof(void*);
+        size_t chunk = (block + sizeof(size_t) + align - 1) / align * align;
+        return std::max(chunk, 2 * align);
+    }
+
+    static constexpr char checkpoint_magic[8] = {'B', 'P', 'T', 'R', 'E', 'E', '\0', '\0'};
+    static constexpr uint32_t checkpoint_version = 1;
+    static constexpr size_t checkpoint_block = 1 << 16;
+    static constexpr size_t checkpoint_block_max = checkpoint_block << 8;
+
+    static uint64_t checksum(const char* data, size_t cnt) {
+        uint64_t hash = 0x9e3779b97f4a7c15ull ^ cnt;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= cnt; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+            hash ^= hash >> 32;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, data + i, cnt - i);
+        hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53ull;
+        return hash ^ (hash >> 29);
+    }
+
+    template <typename U>
+    static void write_raw(std::ostream& out, const U& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(U));
+    }
+
+    template <typename U>
+    static U read_raw(std::istream& in) {
+        U value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(U))) {
+            throw std::runtime_error("BPlusTree: truncated checkpoint");
+        }
+        return value;
+    }
+
+    static void write_block(std::ostream& out, const std::vector<char>& block, uint64_t cnt) {
+        write_raw<uint64_t>(out, block.size());
+        write_raw<uint64_t>(out, cnt);
+        write_raw<uint64_t>(out, checksum(block.data(), block.size()));
+        out.write(block.data(), block.size());
+    }
+
+    void build_levels(size_t cnt) {
+        std::shared_ptr<Child> level = root->child;
+        while (cnt > 1) {
+            size_t groups = (cnt + 2 * k - 2) / (2 * k - 1);
+            std::shared_ptr<Child> next_level;
+            Child* tail = nullptr;
+            std::shared_ptr<Child> cur = level;
+            for (size_t i = 0; i < groups; ++i) {
+                size_t len = cnt / groups + (i < cnt % groups ? 1 : 0);
+                Child* last = cur.get();
+                for (size_t j = 1; j < len; ++j) {
+                    last = last->right.get();
+                }
+                std::shared_ptr<Child> next = last->right;
+                std::shared_ptr<Usual> node = std::make_shared<Usual>();
+                node->set_children(cur, last);
+                if (tail == nullptr) {
+                    next_level = node;
+                } else {
+                    node->left = tail;
+                    tail->right = node;
+                }
+                tail = node.get();
+                cur = std::move(next);
+            }
+            level = std::move(next_level);
+            cnt = groups;
+        }
+        root->set_children(level, level.get());
+    }
 
 public:
-    BPlusTree(): root(new Root()), first(nullptr), _size(0) {}
+    BPlusTree(): root(std::make_shared<Root>()), first(nullptr), _size(0), learned() {}
 
     BPlusTree(const BPlusTree&) = delete;
 
-    BPlusTree(BPlusTree&& other): root(nullptr), first(nullptr), _size(0) {
+    BPlusTree(BPlusTree&& other): root(nullptr), first(nullptr), _size(0), learned() {
         std::swap(root, other.root);
         std::swap(_size, other._size);
         std::swap(first, other.first);
+        std::swap(learned, other.learned);
     }
 
     BPlusTree& operator=(const BPlusTree&) = delete;
@@ -361,6 +874,26 @@ public:
         std::swap(root, other.root);
         std::swap(_size, other._size);
         std::swap(first, other.first);
+        std::swap(learned, other.learned);
+        return *this;
+    }
+
+    ~BPlusTree() {
+        if (!root || !root->child) {
+            return;
+        }
+        std::vector<Child*> leftmost;
+        for (Child* v = root->child.get(); v != first; v = static_cast<Usual*>(v)->child.get()) {
+            leftmost.push_back(v);
+        }
+        leftmost.push_back(first);
+        for (auto it = leftmost.rbegin(); it != leftmost.rend(); ++it) {
+            std::shared_ptr<Child> cur = std::move((*it)->right);
+            while (cur) {
+                std::shared_ptr<Child> next = std::move(cur->right);
+                cur = std::move(next);
+            }
+        }
     }
 
     size_t size() const {
@@ -391,55 +924,58 @@ public:
         if (empty()) {
             return const_iterator(nullptr, root.get());
         }
-        return const_iterator(root->find(data, FIND), root.get());
+        return const_iterator(descend(data, FIND), root.get());
     }
 
     const_iterator lower_bound(const T& data) const {
         if (empty()) {
             return const_iterator(nullptr, root.get());
         }
-        return const_iterator(root->find(data, LOWER_BOUND), root.get());
+        return const_iterator(descend(data, LOWER_BOUND), root.get());
     }
 
     const_iterator upper_bound(const T& data) const {
         if (empty()) {
             return const_iterator(nullptr, root.get());
         }
-        return const_iterator(root->find(data, UPPER_BOUND), root.get());
+        return const_iterator(descend(data, UPPER_BOUND), root.get());
     }
 
     iterator find(const T& data) {
         if (empty()) {
             return iterator(nullptr, root.get());
         }
-        return iterator(root->find(data, FIND), root.get());
+        return iterator(descend(data, FIND), root.get());
     }
 
     iterator lower_bound(const T& data) {
         if (empty()) {
             return iterator(nullptr, root.get());
         }
-        return iterator(root->find(data, LOWER_BOUND), root.get());
+        return iterator(descend(data, LOWER_BOUND), root.get());
     }
 
     iterator upper_bound(const T& data) {
         if (empty()) {
             return iterator(nullptr, root.get());
         }
-        return iterator(root->find(data, UPPER_BOUND), root.get());
+        return iterator(descend(data, UPPER_BOUND), root.get());
     }
 
     template <typename U>
     void insert(U&& data) {
+        root->_counters.on_insert();
         ++_size;
         if (empty()) {
-            std::shared_ptr<Leaf> leaf(new Leaf(std::forward<U>(data)));
+            std::shared_ptr<Leaf> leaf = std::make_shared<Leaf>(std::forward<U>(data));
             root->set_children(leaf, leaf.get());
             first = leaf.get();
+            learned_maintain();
             return;
         }
-        auto it = root->find(data, LOWER_BOUND);
-        std::shared_ptr<Leaf> leaf(new Leaf(std::forward<U>(data)));
+        auto it = descend(data, LOWER_BOUND);
+        std::shared_ptr<Leaf> leaf = std::make_shared<Leaf>(std::forward<U>(data));
+        learned_insert(leaf.get());
         if (it == nullptr) {
             root->max_leaf()->insert_right(leaf);
         } else {
@@ -449,6 +985,7 @@ public:
             it->insert_left(leaf);
         }
         leaf->parent->update();
+        learned_maintain();
         return;
     }
 
@@ -456,12 +993,19 @@ public:
         if (it.node == nullptr) {
             return;
         }
+        root->_counters.on_erase();
         --_size;
         if (size() == 0) {
-            root = std::shared_ptr<Root>(new Root());
+            std::shared_ptr<Root> fresh = std::make_shared<Root>();
+            fresh->_counters = root->_counters;
+            root = fresh;
             first = nullptr;
+            if (learned) {
+                learned->clear();
+            }
             return;
         }
+        learned_erase(it.node);
         if (it.node == first) {
             first = static_cast<Leaf*>(it.node->right.get());
             it.node->erase();
@@ -470,6 +1014,7 @@ public:
             it.node->erase();
             tmp->parent->update();
         }
+        learned_maintain();
         return;
     }
 
@@ -478,4 +1023,172 @@ public:
         erase(it);
         return;
     }
+
+    BPlusTreeStats stats() const {
+        BPlusTreeStats result{_size, 0, 0, 0, 0, 0, 0, 0, sizeof(*this) + node_bytes(sizeof(Root)), 0};
+        if (learned) {
+            result.bytes += learned->bytes();
+        }
+        if (empty()) {
+            return result;
+        }
+        size_t total_children = 0;
+        const Child* level = root->child.get();
+        while (true) {
+            ++result.height;
+            if (level == first) {
+                result.leaves = _size;
+                result.bytes += _size * node_bytes(sizeof(Leaf));
+                break;
+            }
+            for (const Child* v = level; v != nullptr; v = v->right.get()) {
+                size_t cnt = static_cast<const Usual*>(v)->cnt_child;
+                if (result.inner_nodes == 0 || cnt < result.min_children) {
+                    result.min_children = cnt;
+                }
+                result.max_children = std::max(result.max_children, cnt);
+                total_children += cnt;
+                ++result.inner_nodes;
+            }
+            level = static_cast<const Usual*>(level)->child.get();
+        }
+        result.bytes += result.inner_nodes * node_bytes(sizeof(Usual));
+        if (result.inner_nodes != 0) {
+            result.average_children = static_cast<double>(total_children) / result.inner_nodes;
+            result.fill_ratio = result.average_children / (2 * k - 1);
+        }
+        result.bytes_per_key = static_cast<double>(result.bytes) / _size;
+        return result;
+    }
+
+    const Counters& counters() const {
+        return root->_counters;
+    }
+
+    void reset_counters() {
+        root->_counters = Counters();
+    }
+
+    void enable_learned_index(size_t epsilon = 16) {
+        static_assert(learnable, "the learned index needs non-bool arithmetic keys ordered by std::less");
+        learned.reset(new LearnedIndex(epsilon));
+        learned->rebuild(first);
+    }
+
+    void disable_learned_index() {
+        learned.reset();
+    }
+
+    size_t learned_segments() const {
+        return learned ? learned->size() : 0;
+    }
+
+    template <typename Serializer = BPlusTreeSerializer<T>>
+    void save(std::ostream& out) const {
+        out.write(checkpoint_magic, sizeof(checkpoint_magic));
+        write_raw<uint32_t>(out, checkpoint_version);
+        write_raw<uint32_t>(out, Serializer::width);
+        write_raw<uint64_t>(out, _size);
+        std::vector<char> block;
+        block.reserve(checkpoint_block);
+        uint64_t cnt = 0;
+        for (const Leaf* v = first; v != nullptr; v = static_cast<const Leaf*>(v->right.get())) {
+            Serializer::write(block, v->data);
+            ++cnt;
+            if (block.size() > checkpoint_block_max) {
+                throw std::runtime_error("BPlusTree: key too large for checkpoint");
+            }
+            if (block.size() >= checkpoint_block || !v->right) {
+                write_block(out, block, cnt);
+                block.clear();
+                cnt = 0;
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("BPlusTree: cannot write checkpoint");
+        }
+    }
+
+    template <typename Serializer = BPlusTreeSerializer<T>>
+    void save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("BPlusTree: cannot open " + path);
+        }
+        save<Serializer>(out);
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("BPlusTree: cannot write " + path);
+        }
+    }
+
+    template <typename Serializer = BPlusTreeSerializer<T>>
+    static BPlusTree load(std::istream& in) {
+        char magic[sizeof(checkpoint_magic)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, checkpoint_magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("BPlusTree: not a checkpoint");
+        }
+        if (read_raw<uint32_t>(in) != checkpoint_version) {
+            throw std::runtime_error("BPlusTree: unsupported checkpoint version");
+        }
+        if (read_raw<uint32_t>(in) != Serializer::width) {
+            throw std::runtime_error("BPlusTree: checkpoint key width mismatch");
+        }
+        uint64_t cnt = read_raw<uint64_t>(in);
+        BPlusTree tree;
+        Leaf* last = nullptr;
+        std::vector<char> block;
+        for (uint64_t loaded = 0; loaded < cnt;) {
+            uint64_t bytes = read_raw<uint64_t>(in);
+            uint64_t keys = read_raw<uint64_t>(in);
+            uint64_t sum = read_raw<uint64_t>(in);
+            if (keys == 0 || keys > cnt - loaded || bytes < keys || bytes > checkpoint_block_max) {
+                throw std::runtime_error("BPlusTree: corrupt checkpoint block");
+            }
+            if (Serializer::width != 0 && bytes != keys * Serializer::width) {
+                throw std::runtime_error("BPlusTree: corrupt checkpoint block");
+            }
+            block.resize(bytes);
+            if (!in.read(block.data(), bytes)) {
+                throw std::runtime_error("BPlusTree: truncated checkpoint");
+            }
+            if (checksum(block.data(), bytes) != sum) {
+                throw std::runtime_error("BPlusTree: checkpoint checksum mismatch");
+            }
+            const char* pos = block.data();
+            const char* end = pos + bytes;
+            for (uint64_t i = 0; i < keys; ++i) {
+                std::shared_ptr<Leaf> leaf = std::make_shared<Leaf>(Serializer::read(pos, end));
+                if (last == nullptr) {
+                    tree.root->child = leaf;
+                    tree.first = leaf.get();
+                } else {
+                    if (Compare()(leaf->data, last->data)) {
+                        throw std::runtime_error("BPlusTree: checkpoint keys out of order");
+                    }
+                    leaf->left = last;
+                    last->right = leaf;
+                }
+                last = leaf.get();
+            }
+            if (pos != end) {
+                throw std::runtime_error("BPlusTree: corrupt checkpoint block");
+            }
+            loaded += keys;
+        }
+        if (cnt != 0) {
+            tree._size = cnt;
+            tree.build_levels(cnt);
+        }
+        return tree;
+    }
+
+    template <typename Serializer = BPlusTreeSerializer<T>>
+    static BPlusTree load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("BPlusTree: cannot open " + path);
+        }
+        return load<Serializer>(in);
+    }
 };  